@@ -0,0 +1,139 @@
+#ifndef SJTU_ARC_LRU_HPP
+#define SJTU_ARC_LRU_HPP
+
+#include "lru.hpp"
+
+/**
+    自适应替换缓存（ARC），接口同lru
+        sjtu :: arc_lru < Key , Value , Hash , Equal >
+    T1放只被访问过一次的元素，T2放被访问过至少两次的元素，两者合起来不超过容量c；
+    B1、B2是从T1、T2淘汰出去的键（幽灵表），只存键不存值，合起来也不超过c。
+    save的键命中B1说明T1给小了，调大T1的目标大小p；命中B2则调小p，p决定下次从哪边淘汰。
+    四张表都是linked_hashmap，从旧到新排列。get只处理T1/T2的命中，幽灵表的命中要等save带着值进来时才算。
+*/
+
+namespace sjtu {
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class arc_lru {
+        using lmap = sjtu::linked_hashmap<Key, Value, KeyHash, KeyEqual>;
+        using ghost_map = sjtu::linked_hashmap<Key, bool, KeyHash, KeyEqual>; //幽灵表，值没有意义
+        using value_type = sjtu::pair<const Key, Value>;
+
+        size_t capacity;
+        size_t target; //T1的目标大小p，在0到capacity之间自适应
+        lmap t1;
+        lmap t2;
+        ghost_map b1;
+        ghost_map b2;
+
+        //把T1或T2最旧的元素淘汰，键移到对应幽灵表的最新端
+        //T1超过目标大小（或者这次命中的是B2且T1正好等于目标）时淘汰T1，否则淘汰T2
+        void replace(bool in_b2) {
+            if (!t1.empty() && (t1.size() > target || (in_b2 && t1.size() == target) || t2.empty())) {
+                auto oldest = t1.begin();
+                b1.insert(pair<const Key, bool>(oldest->first, true));
+                t1.remove(oldest);
+            } else {
+                auto oldest = t2.begin();
+                b2.insert(pair<const Key, bool>(oldest->first, true));
+                t2.remove(oldest);
+            }
+        }
+
+        //T1或T2命中：移到T2的最新端，T1里的值移动过去，不拷贝
+        Value *hit(const Key &key) {
+            auto it = t2.find(key);
+            if (it != t2.end()) {
+                t2.touch(it);
+                return &(it->second);
+            }
+            it = t1.find(key);
+            if (it != t1.end()) {
+                auto result = t2.try_emplace(it->first, std::move(it->second));
+                t1.remove(it);
+                return &(result.first->second);
+            }
+            return nullptr;
+        }
+
+    public:
+        arc_lru(int size) : capacity(size), target(0) {
+        }
+
+        void save(const value_type &v) {
+            Value *value = hit(v.first);
+            if (value != nullptr) {
+                *value = v.second;
+                return;
+            }
+            if (capacity == 0) {
+                return;
+            }
+            auto ghost = b1.find(v.first);
+            if (ghost != b1.end()) {
+                // 命中B1：调大T1的目标
+                target = std::min(capacity, target + std::max<size_t>(b2.size() / b1.size(), 1));
+                if (t1.size() + t2.size() >= capacity) {
+                    replace(false);
+                }
+                b1.remove(ghost);
+                t2.insert(v);
+                return;
+            }
+            ghost = b2.find(v.first);
+            if (ghost != b2.end()) {
+                // 命中B2：调小T1的目标
+                size_t delta = std::max<size_t>(b1.size() / b2.size(), 1);
+                target = target > delta ? target - delta : 0;
+                if (t1.size() + t2.size() >= capacity) {
+                    replace(true);
+                }
+                b2.remove(ghost);
+                t2.insert(v);
+                return;
+            }
+            // 完全没见过的键
+            if (t1.size() + b1.size() == capacity) {
+                if (t1.size() < capacity) {
+                    b1.remove(b1.begin());
+                    if (t1.size() + t2.size() == capacity) {
+                        replace(false);
+                    }
+                } else {
+                    t1.remove(t1.begin());
+                }
+            } else if (t1.size() + t2.size() + b1.size() + b2.size() >= capacity) {
+                if (t1.size() + t2.size() + b1.size() + b2.size() == 2 * capacity) {
+                    b2.remove(b2.begin());
+                }
+                if (t1.size() + t2.size() == capacity) {
+                    replace(false);
+                }
+            }
+            t1.insert(v);
+        }
+
+        Value *get(const Key &v) {
+            return hit(v);
+        }
+
+        size_t size() const {
+            return t1.size() + t2.size();
+        }
+
+        //依次输出T1、T2，每个从旧到新
+        void print() {
+            for (lmap *list: {&t1, &t2}) {
+                for (auto it = list->begin(); it != list->end(); ++it) {
+                    std::cout << (*it).first << " " << (*it).second << std::endl;
+                }
+            }
+        }
+    };
+}
+
+#endif
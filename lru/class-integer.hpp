@@ -1,6 +1,8 @@
 #ifndef SJTU_INTEGER_HPP
 #define SJTU_INTEGER_HPP
 
+#include <iostream>
+
 /**
     整数类Integer，静态变量counter记录变量构造/析构的次数。程序运行结束时应该为0
     对象构造和输出示例如下：
@@ -28,4 +30,9 @@ public:
 
 int Integer::counter = 0;
 
+//输出Integer的值，供lru::print等按通用方式输出键
+inline std::ostream &operator<<(std::ostream &stream, const Integer &x) {
+    return stream << x.val;
+}
+
 #endif
@@ -7,29 +7,112 @@
         Matrix < int > * p = new Matrix < int >(1 ,2 ,3);
         std :: cout << a << " " << *p << std :: endl ;
     构造1*2，填充的数字都为3的矩阵
+
+    逐元素的运算（+、-、取负、乘数、除以数）不马上计算，而是返回一个表达式对象，
+    赋值给 Matrix 或者用来构造 Matrix 时才一次遍历算出所有元素，整条式子只分配一次内存：
+        Matrix < int > c = a + b - a * 2 ; // 不产生中间矩阵
+    表达式里的矩阵按引用保存，不要用 auto 保存表达式再去修改或销毁其中的矩阵。
+    矩阵乘法、转置、幂运算的参数如果是表达式，会先算成矩阵。
 */
 
 #include <iostream>
 #include <iomanip>
-#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <stdexcept>
 
+#include "matrix-kernel.hpp"
+
+// 所有逐元素表达式（包括 Matrix 本身）的基类，E 是派生类
+// 派生类提供 value_type、RowSize()、ColSize() 和按行连续下标取值的 Flat(i)
+template<typename E>
+class MatrixExpression {
+public:
+    const E &self() const {
+        return static_cast<const E &>(*this);
+    }
+};
+
 // 定义一个模板类 Matrix，模板参数为 _Td，表示矩阵中元素的类型
+// 所有元素按行连续存放在一块对齐的内存里，整个矩阵只分配一次
 template<typename _Td>
-class Matrix {
+class Matrix : public MatrixExpression<Matrix<_Td> > {
 protected:
+    // 数据首地址的对齐，至少一个缓存行，方便按向量读写
+    static constexpr size_t ALIGNMENT = alignof(_Td) > 64 ? alignof(_Td) : 64;
+
     size_t n_rows = 0; // 矩阵的行数
     size_t n_cols = 0; // 矩阵的列数
-    std::vector<std::vector<_Td> > data; // 二维向量，用于存储矩阵的数据
+    _Td *data = nullptr; // 按行存放的 n_rows * n_cols 个元素，第 i 行从 data + i * n_cols 开始
+
+    // 分配能放 n 个元素的对齐内存，不构造元素
+    static _Td *allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        return static_cast<_Td *>(::operator new(n * sizeof(_Td), std::align_val_t(ALIGNMENT)));
+    }
+
+    // 析构前 n 个元素并释放内存
+    static void release(_Td *p, size_t n) {
+        if (p == nullptr) {
+            return;
+        }
+        if constexpr (!std::is_trivially_destructible_v<_Td>) {
+            std::destroy_n(p, n);
+        }
+        ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+
+    // 分配内存后用 init 构造元素，构造抛异常时释放内存再抛出
+    template<typename Init>
+    static _Td *create(size_t n, Init init) {
+        _Td *p = allocate(n);
+        try {
+            init(p);
+        } catch (...) {
+            ::operator delete(p, std::align_val_t(ALIGNMENT));
+            throw;
+        }
+        return p;
+    }
+
+    // 把 n 个元素从 src 复制到已经构造好的 dst，能按字节复制的直接 memcpy
+    static void copy_elements(const _Td *src, size_t n, _Td *dst) {
+        if constexpr (std::is_trivially_copyable_v<_Td>) {
+            if (n != 0) {
+                std::memcpy(dst, src, n * sizeof(_Td));
+            }
+        } else {
+            std::copy_n(src, n, dst);
+        }
+    }
+
+    // 分配新内存，从 src 复制构造 n 个元素
+    static _Td *clone(const _Td *src, size_t n) {
+        return create(n, [&](_Td *p) {
+            if constexpr (std::is_trivially_copyable_v<_Td>) {
+                if (n != 0) {
+                    std::memcpy(p, src, n * sizeof(_Td));
+                }
+            } else {
+                std::uninitialized_copy_n(src, n, p);
+            }
+        });
+    }
 
     //————————————————————————————————————————————————————————//
     // 内部类 RowProxy，用于代理矩阵的一行，方便对矩阵元素进行访问
     class RowProxy {
-        std::vector<_Td> &row; // 引用矩阵中的一行
+        _Td *row; // 指向矩阵中一行的开头
 
     public:
-        // 构造函数，接收一个向量引用，初始化 row
-        RowProxy(std::vector<_Td> &_row) : row(_row) {
+        // 构造函数，接收一行的首地址，初始化 row
+        RowProxy(_Td *_row) : row(_row) {
         }
 
         // 重载 [] 运算符，用于访问行中的元素
@@ -42,11 +125,11 @@ protected:
     //————————————————————————————————————————————————————————//
     // 内部类 ConstRowProxy，用于代理常量矩阵的一行，方便对常量矩阵元素进行访问
     class ConstRowProxy {
-        const std::vector<_Td> &row; // 引用常量矩阵中的一行
+        const _Td *row; // 指向常量矩阵中一行的开头
 
     public:
-        // 构造函数，接收一个常量向量引用，初始化 row
-        ConstRowProxy(const std::vector<_Td> &_row) : row(_row) {
+        // 构造函数，接收一行的常量首地址，初始化 row
+        ConstRowProxy(const _Td *_row) : row(_row) {
         }
 
         // 重载 [] 运算符，用于访问常量行中的元素，返回常量引用
@@ -56,47 +139,118 @@ protected:
     };
 
 public:
+    using value_type = _Td; // 元素类型
+
     // 默认构造函数，创建一个空矩阵
     Matrix() {
     };
 
     // 构造函数，根据指定的行数和列数创建矩阵，元素初始化为默认值
     Matrix(const size_t &_n_rows, const size_t &_n_cols)
-        : n_rows(_n_rows), n_cols(_n_cols), data(std::vector<std::vector<_Td> >(n_rows, std::vector<_Td>(n_cols))) {
+        : n_rows(_n_rows), n_cols(_n_cols),
+          data(create(n_rows * n_cols, [&](_Td *p) { std::uninitialized_value_construct_n(p, n_rows * n_cols); })) {
     }
 
     // 构造函数，根据指定的行数、列数和填充值创建矩阵
     Matrix(const size_t &_n_rows, const size_t &_n_cols, const _Td &fillValue)
         : n_rows(_n_rows), n_cols(_n_cols),
-          data(std::vector<std::vector<_Td> >(n_rows, std::vector<_Td>(n_cols, fillValue))) {
+          data(create(n_rows * n_cols, [&](_Td *p) { std::uninitialized_fill_n(p, n_rows * n_cols, fillValue); })) {
     }
 
     // 拷贝构造函数，用于创建一个新矩阵，其内容与另一个矩阵相同
     Matrix(const Matrix<_Td> &mat)
-        : n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {
+        : n_rows(mat.n_rows), n_cols(mat.n_cols), data(clone(mat.data, mat.n_rows * mat.n_cols)) {
     }
 
     // 移动构造函数，用于高效地将一个临时矩阵的资源转移到新矩阵中
     Matrix(Matrix<_Td> &&mat) noexcept
         : n_rows(mat.n_rows), n_cols(mat.n_cols), data(mat.data) {
+        mat.n_rows = mat.n_cols = 0;
+        mat.data = nullptr;
+    }
+
+    // 由逐元素表达式构造，分配一次内存，一次遍历算出所有元素
+    template<typename E>
+    Matrix(const MatrixExpression<E> &expr)
+        : n_rows(expr.self().RowSize()), n_cols(expr.self().ColSize()),
+          data(create(n_rows * n_cols, [&](_Td *p) {
+              const E &e = expr.self();
+              const size_t n = n_rows * n_cols;
+              if constexpr (std::is_trivially_copyable_v<_Td>) {
+                  matrix_kernel::parallel_for(n, 1, [&](size_t begin, size_t end) {
+                      for (size_t i = begin; i < end; ++i) {
+                          p[i] = e.Flat(i);
+                      }
+                  });
+              } else {
+                  size_t i = 0;
+                  try {
+                      for (; i < n; ++i) {
+                          ::new(static_cast<void *>(p + i)) _Td(e.Flat(i));
+                      }
+                  } catch (...) {
+                      std::destroy_n(p, i);
+                      throw;
+                  }
+              }
+          })) {
     }
 
     // 拷贝赋值运算符，用于将一个矩阵的内容复制到另一个矩阵中
+    // 元素个数相同时直接覆盖原来的内存，不重新分配
     Matrix<_Td> &operator=(const Matrix<_Td> &rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+        if (n_rows * n_cols == rhs.n_rows * rhs.n_cols) {
+            copy_elements(rhs.data, rhs.n_rows * rhs.n_cols, data);
+        } else {
+            _Td *p = clone(rhs.data, rhs.n_rows * rhs.n_cols);
+            release(data, n_rows * n_cols);
+            data = p;
+        }
         this->n_rows = rhs.n_rows;
         this->n_cols = rhs.n_cols;
-        this->data = rhs.data;
         return *this;
     }
 
     // 移动赋值运算符，用于高效地将一个临时矩阵的资源转移到另一个矩阵中
-    Matrix<_Td> &operator=(Matrix<_Td> &&rhs) {
-        this->n_rows = rhs.n_rows;
-        this->n_cols = rhs.n_cols;
-        this->data = rhs.data;
+    Matrix<_Td> &operator=(Matrix<_Td> &&rhs) noexcept {
+        std::swap(n_rows, rhs.n_rows);
+        std::swap(n_cols, rhs.n_cols);
+        std::swap(data, rhs.data);
+        return *this;
+    }
+
+    // 把逐元素表达式的值赋给矩阵；大小相同时直接写进原来的内存，不重新分配
+    // 每个元素只依赖各个矩阵同一位置的元素，所以表达式里出现自己（a = a + b）也没问题
+    template<typename E>
+    Matrix<_Td> &operator=(const MatrixExpression<E> &expr) {
+        const E &e = expr.self();
+        if (n_rows * n_cols != e.RowSize() * e.ColSize()) {
+            return *this = Matrix<_Td>(expr);
+        }
+        n_rows = e.RowSize();
+        n_cols = e.ColSize();
+        matrix_kernel::parallel_for(n_rows * n_cols, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                data[i] = e.Flat(i);
+            }
+        });
         return *this;
     }
 
+    // 改成 _n_rows 行 _n_cols 列、元素都是 fillValue 的矩阵；元素个数不变时不重新分配内存
+    void Assign(const size_t &_n_rows, const size_t &_n_cols, const _Td &fillValue) {
+        if (n_rows * n_cols != _n_rows * _n_cols) {
+            *this = Matrix<_Td>(_n_rows, _n_cols, fillValue);
+            return;
+        }
+        n_rows = _n_rows;
+        n_cols = _n_cols;
+        std::fill_n(data, n_rows * n_cols, fillValue);
+    }
+
     // 获取矩阵行数的常量成员函数，返回行数的常量引用
     inline const size_t &RowSize() const {
         return n_rows;
@@ -107,165 +261,255 @@ public:
         return n_cols;
     }
 
+    // 按行连续存放的元素首地址，第 i 行第 j 列是 Data()[i * ColSize() + j]
+    inline _Td *Data() {
+        return data;
+    }
+
+    inline const _Td *Data() const {
+        return data;
+    }
+
+    // 按行连续的下标取元素，供表达式求值使用
+    inline const _Td &Flat(const size_t &i) const {
+        return data[i];
+    }
+
     // 重载 [] 运算符，返回 RowProxy 对象，用于访问矩阵的某一行
     RowProxy operator[](const size_t &Kth) {
-        return RowProxy(this->data[Kth]);
+        return RowProxy(this->data + Kth * n_cols);
     }
 
     // 重载 [] 运算符，用于常量矩阵，返回 ConstRowProxy 对象，用于访问常量矩阵的某一行
     const ConstRowProxy operator[](const size_t &Kth) const {
-        return ConstRowProxy(this->data[Kth]);
+        return ConstRowProxy(this->data + Kth * n_cols);
     }
 
-    // 默认析构函数
-    ~Matrix() = default;
+    // 析构函数，析构所有元素并释放内存
+    ~Matrix() {
+        release(data, n_rows * n_cols);
+    }
 };
 
-/**
- * 两个矩阵相加的运算符重载函数
- */
-template<typename _Td>
-Matrix<_Td> operator+(const Matrix<_Td> &a, const Matrix<_Td> &b) {
-    // 检查两个矩阵的行数和列数是否相同，如果不同则抛出异常
-    if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
-        throw std::invalid_argument("different matrics\'s sizes");
-    }
-    // 创建一个新矩阵，用于存储相加的结果
-    Matrix<_Td> c(a.RowSize(), a.ColSize());
-    // 遍历矩阵的每一个元素，将对应位置的元素相加
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            c[i][j] = a[i][j] + b[i][j];
+//————————————————————————————————————————————————————————//
+// 逐元素表达式的各种节点
+namespace matrix_expression {
+    // 表达式里的操作数：矩阵按引用保存，其他表达式节点很小，按值保存
+    template<typename E>
+    struct operand {
+        using type = const E;
+    };
+
+    template<typename T>
+    struct operand<Matrix<T> > {
+        using type = const Matrix<T> &;
+    };
+
+    // 两个同样大小的表达式逐元素运算
+    template<typename L, typename R, typename Op>
+    class Binary : public MatrixExpression<Binary<L, R, Op> > {
+        typename operand<L>::type lhs;
+        typename operand<R>::type rhs;
+
+    public:
+        using value_type = typename L::value_type;
+
+        Binary(const L &l, const R &r) : lhs(l), rhs(r) {
+            // 检查两个矩阵的行数和列数是否相同，如果不同则抛出异常
+            if (l.RowSize() != r.RowSize() || l.ColSize() != r.ColSize()) {
+                throw std::invalid_argument("different matrics\'s sizes");
+            }
         }
-    }
-    return c;
-}
 
-// 两个矩阵相减的运算符重载函数
-template<typename _Td>
-Matrix<_Td> operator-(const Matrix<_Td> &a, const Matrix<_Td> &b) {
-    // 检查两个矩阵的行数和列数是否相同，如果不同则抛出异常
-    if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
-        throw std::invalid_argument("different matrics\'s sizes");
-    }
-    // 创建一个新矩阵，用于存储相减的结果
-    Matrix<_Td> c(a.RowSize(), a.ColSize());
-    // 遍历矩阵的每一个元素，将对应位置的元素相减
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            c[i][j] = a[i][j] - b[i][j];
+        size_t RowSize() const { return lhs.RowSize(); }
+        size_t ColSize() const { return lhs.ColSize(); }
+        value_type Flat(const size_t &i) const { return Op::apply(lhs.Flat(i), rhs.Flat(i)); }
+    };
+
+    // 表达式的每个元素单独运算
+    template<typename E, typename Op>
+    class Unary : public MatrixExpression<Unary<E, Op> > {
+        typename operand<E>::type arg;
+
+    public:
+        using value_type = typename E::value_type;
+
+        explicit Unary(const E &e) : arg(e) {
+        }
+
+        size_t RowSize() const { return arg.RowSize(); }
+        size_t ColSize() const { return arg.ColSize(); }
+        value_type Flat(const size_t &i) const { return Op::apply(arg.Flat(i)); }
+    };
+
+    // 表达式的每个元素和一个数运算
+    template<typename E, typename S, typename Op>
+    class Scalar : public MatrixExpression<Scalar<E, S, Op> > {
+        typename operand<E>::type arg;
+        S scalar;
+
+    public:
+        using value_type = typename E::value_type;
+
+        Scalar(const E &e, const S &s) : arg(e), scalar(s) {
         }
+
+        size_t RowSize() const { return arg.RowSize(); }
+        size_t ColSize() const { return arg.ColSize(); }
+        value_type Flat(const size_t &i) const { return Op::apply(arg.Flat(i), scalar); }
+    };
+
+    struct Add {
+        template<typename T>
+        static T apply(const T &a, const T &b) { return a + b; }
+    };
+
+    struct Sub {
+        template<typename T>
+        static T apply(const T &a, const T &b) { return a - b; }
+    };
+
+    struct Neg {
+        template<typename T>
+        static T apply(const T &a) { return -a; }
+    };
+
+    struct Mul {
+        template<typename T>
+        static T apply(const T &a, const T &b) { return a * b; }
+    };
+
+    struct Div {
+        template<typename T>
+        static T apply(const T &a, const double &b) { return static_cast<T>(a / b); }
+    };
+
+    // 矩阵乘法等需要真正的矩阵：矩阵直接用，表达式先算成矩阵
+    template<typename T>
+    const Matrix<T> &evaluate(const Matrix<T> &m) {
+        return m;
+    }
+
+    template<typename E>
+    Matrix<typename E::value_type> evaluate(const MatrixExpression<E> &e) {
+        return Matrix<typename E::value_type>(e);
     }
-    return c;
 }
 
-// 判断两个矩阵是否相等的运算符重载函数
-template<typename _Td>
-bool operator==(const Matrix<_Td> &a, const Matrix<_Td> &b) {
+/**
+ * 两个矩阵相加的运算符重载函数，返回表达式，不马上计算
+ */
+template<typename L, typename R>
+matrix_expression::Binary<L, R, matrix_expression::Add>
+operator+(const MatrixExpression<L> &a, const MatrixExpression<R> &b) {
+    static_assert(std::is_same_v<typename L::value_type, typename R::value_type>, "different element types");
+    return matrix_expression::Binary<L, R, matrix_expression::Add>(a.self(), b.self());
+}
+
+// 两个矩阵相减的运算符重载函数，返回表达式
+template<typename L, typename R>
+matrix_expression::Binary<L, R, matrix_expression::Sub>
+operator-(const MatrixExpression<L> &a, const MatrixExpression<R> &b) {
+    static_assert(std::is_same_v<typename L::value_type, typename R::value_type>, "different element types");
+    return matrix_expression::Binary<L, R, matrix_expression::Sub>(a.self(), b.self());
+}
+
+// 判断两个矩阵是否相等的运算符重载函数，表达式逐个元素算出来比较，不生成矩阵
+template<typename L, typename R>
+bool operator==(const MatrixExpression<L> &lhs, const MatrixExpression<R> &rhs) {
+    const L &a = lhs.self();
+    const R &b = rhs.self();
     // 检查两个矩阵的行数和列数是否相同，如果不同则返回 false
     if (a.RowSize() != b.RowSize() || a.ColSize() != b.ColSize()) {
         return false;
     }
     // 遍历矩阵的每一个元素，检查对应位置的元素是否相等
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            if (a[i][j] != b[i][j])
-                return false;
-        }
+    const size_t n = a.RowSize() * a.ColSize();
+    for (size_t i = 0; i < n; ++i) {
+        if (a.Flat(i) != b.Flat(i))
+            return false;
     }
     return true;
 }
 
-// 矩阵取负的运算符重载函数
-template<typename _Td>
-Matrix<_Td> operator-(const Matrix<_Td> &mat) {
-    // 创建一个新矩阵，用于存储取负的结果
-    Matrix<_Td> result(mat.RowSize(), mat.ColSize());
-    // 遍历矩阵的每一个元素，将其取负
-    for (size_t i = 0; i < mat.RowSize(); ++i) {
-        for (size_t j = 0; j < mat.ColSize(); ++j) {
-            result[i][j] = -mat[i][j];
-        }
-    }
-    return result;
+// 矩阵取负的运算符重载函数，返回表达式
+template<typename E>
+matrix_expression::Unary<E, matrix_expression::Neg> operator-(const MatrixExpression<E> &mat) {
+    return matrix_expression::Unary<E, matrix_expression::Neg>(mat.self());
 }
 
-// 移动语义的矩阵取负的运算符重载函数
+// 移动语义的矩阵取负的运算符重载函数，直接在传进来的临时矩阵上取负
 template<typename _Td>
 Matrix<_Td> operator-(Matrix<_Td> &&mat) {
     // 遍历矩阵的每一个元素，将其取负
-    for (size_t i = 0; i < mat.RowSize(); ++i) {
-        for (size_t j = 0; j < mat.ColSize(); ++j) {
-            mat[i][j] = -mat[i][j];
+    const size_t n = mat.RowSize() * mat.ColSize();
+    matrix_kernel::parallel_for(n, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            mat.Data()[i] = -mat.Data()[i];
         }
-    }
+    });
     return mat;
 }
 
 /**
- * 两个矩阵相乘的运算符重载函数
+ * 矩阵乘法，结果写进 c，c 原来的内存够用时不重新分配；c 不能是 a 或 b
  */
 template<typename _Td>
-Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b) {
+void Multiply(const Matrix<_Td> &a, const Matrix<_Td> &b, Matrix<_Td> &c) {
     // 检查第一个矩阵的列数是否等于第二个矩阵的行数，如果不同则抛出异常
     if (a.ColSize() != b.RowSize()) {
         throw std::invalid_argument("different matrics\'s sizes");
     }
-    // 创建一个新矩阵，用于存储相乘的结果
-    Matrix<_Td> c(a.RowSize(), b.ColSize(), 0);
-    // 矩阵乘法的核心逻辑，使用三重循环计算结果矩阵的每一个元素
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < b.ColSize(); ++j) {
-            for (size_t k = 0; k < a.ColSize(); ++k) {
-                c[i][j] += a[i][k] * b[k][j];
-            }
-        }
+    if (&c == &a || &c == &b) {
+        throw std::invalid_argument("the result matrix is also an operand");
+    }
+    c.Assign(a.RowSize(), b.ColSize(), 0);
+    // 算术类型走分块打包的内核，其他类型按 i-k-j 的顺序直接算
+    if constexpr (std::is_arithmetic_v<_Td>) {
+        matrix_kernel::gemm(a.RowSize(), b.ColSize(), a.ColSize(), a.Data(), b.Data(), c.Data());
+    } else {
+        matrix_kernel::gemm_small(a.RowSize(), b.ColSize(), a.ColSize(), a.Data(), b.Data(), c.Data());
     }
-    return c;
 }
 
 /**
- * 矩阵与数相乘的运算符重载函数
+ * 两个矩阵相乘的运算符重载函数
  */
 template<typename _Td>
-Matrix<_Td> operator*(const Matrix<_Td> &a, const _Td &b) {
+Matrix<_Td> operator*(const Matrix<_Td> &a, const Matrix<_Td> &b) {
     // 创建一个新矩阵，用于存储相乘的结果
-    Matrix<_Td> c(a.RowSize(), a.ColSize());
-    // 遍历矩阵的每一个元素，将其与数相乘
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            c[i][j] = a[i][j] * b;
-        }
-    }
+    Matrix<_Td> c;
+    Multiply(a, b, c);
     return c;
 }
 
-// 数与矩阵相乘的运算符重载函数
-template<typename _Td>
-Matrix<_Td> operator*(const _Td &b, const Matrix<_Td> &a) {
-    // 创建一个新矩阵，用于存储相乘的结果
-    Matrix<_Td> c(a.RowSize(), a.ColSize());
-    // 遍历矩阵的每一个元素，将其与数相乘
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            c[i][j] = a[i][j] * b;
-        }
-    }
-    return c;
+// 有一边是表达式的矩阵乘法，先把表达式算成矩阵
+template<typename L, typename R>
+Matrix<typename L::value_type> operator*(const MatrixExpression<L> &a, const MatrixExpression<R> &b) {
+    return matrix_expression::evaluate(a.self()) * matrix_expression::evaluate(b.self());
 }
 
-// 矩阵除以数的运算符重载函数
-template<typename _Td>
-Matrix<_Td> operator/(const Matrix<_Td> &a, const double &b) {
-    // 创建一个新矩阵，用于存储相除的结果
-    Matrix<_Td> c(a.RowSize(), a.ColSize());
-    // 遍历矩阵的每一个元素，将其除以数
-    for (size_t i = 0; i < a.RowSize(); ++i) {
-        for (size_t j = 0; j < a.ColSize(); ++j) {
-            c[i][j] = a[i][j] / b;
-        }
-    }
-    return c;
+/**
+ * 矩阵与数相乘的运算符重载函数，返回表达式
+ */
+template<typename E>
+matrix_expression::Scalar<E, typename E::value_type, matrix_expression::Mul>
+operator*(const MatrixExpression<E> &a, const typename E::value_type &b) {
+    return matrix_expression::Scalar<E, typename E::value_type, matrix_expression::Mul>(a.self(), b);
+}
+
+// 数与矩阵相乘的运算符重载函数，返回表达式
+template<typename E>
+matrix_expression::Scalar<E, typename E::value_type, matrix_expression::Mul>
+operator*(const typename E::value_type &b, const MatrixExpression<E> &a) {
+    return matrix_expression::Scalar<E, typename E::value_type, matrix_expression::Mul>(a.self(), b);
+}
+
+// 矩阵除以数的运算符重载函数，返回表达式
+template<typename E>
+matrix_expression::Scalar<E, double, matrix_expression::Div>
+operator/(const MatrixExpression<E> &a, const double &b) {
+    return matrix_expression::Scalar<E, double, matrix_expression::Div>(a.self(), b);
 }
 
 // 矩阵转置函数
@@ -273,18 +517,27 @@ template<typename _Td>
 Matrix<_Td> Transpose(const Matrix<_Td> &a) {
     // 创建一个新矩阵，行数和列数与原矩阵相反
     Matrix<_Td> res(a.ColSize(), a.RowSize());
-    // 遍历原矩阵，将元素转置到新矩阵中
-    for (size_t i = 0; i < a.ColSize(); ++i) {
-        for (size_t j = 0; j < a.RowSize(); ++j) {
-            res[i][j] = a[j][i];
+    // 遍历原矩阵，将元素转置到新矩阵中，按新矩阵的行块分给多个线程
+    matrix_kernel::parallel_for(a.ColSize(), a.RowSize(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t j = 0; j < a.RowSize(); ++j) {
+                res[i][j] = a[j][i];
+            }
         }
-    }
+    });
     return res;
 }
 
-// 矩阵输出运算符重载函数
-template<typename _Td>
-std::ostream &operator<<(std::ostream &stream, const Matrix<_Td> &mat) {
+// 表达式的转置，先算成矩阵
+template<typename E>
+Matrix<typename E::value_type> Transpose(const MatrixExpression<E> &a) {
+    return Transpose(Matrix<typename E::value_type>(a));
+}
+
+// 矩阵（或表达式）输出运算符重载函数
+template<typename E>
+std::ostream &operator<<(std::ostream &stream, const MatrixExpression<E> &expr) {
+    const E &mat = expr.self();
     // 保存原有的输出格式标志
     std::ostream::fmtflags oldFlags = stream.flags();
     // 设置输出精度为 8 位
@@ -297,7 +550,7 @@ std::ostream &operator<<(std::ostream &stream, const Matrix<_Td> &mat) {
     // 遍历矩阵的每一个元素，按格式输出
     for (size_t i = 0; i < mat.RowSize(); ++i) {
         for (size_t j = 0; j < mat.ColSize(); ++j) {
-            stream << std::setw(15) << mat[i][j];
+            stream << std::setw(15) << mat.Flat(i * mat.ColSize() + j);
         }
         stream << '\n';
     }
@@ -319,24 +572,75 @@ Matrix<_Td> I(const size_t &n) {
     return res;
 }
 
-// 矩阵幂运算函数
+// 矩阵幂运算的工作区：结果、底数和一块草稿，多次对同样大小的矩阵求幂时不再分配内存
+template<typename _Td>
+class PowWorkspace {
+    Matrix<_Td> result; // 当前的结果
+    Matrix<_Td> base; // 当前的底数，每轮平方一次
+    Matrix<_Td> scratch; // 乘法的输出，算完和 result 或 base 交换
+
+    template<typename T>
+    friend const Matrix<T> &Pow(const Matrix<T> &A, size_t b, PowWorkspace<T> &ws);
+
+public:
+    // 把上一次求幂的结果移动出来，工作区里的结果变空，下次求幂时重新分配
+    Matrix<_Td> TakeResult() {
+        return std::move(result);
+    }
+};
+
+// 用工作区求 A 的 b 次幂，不修改 b，返回的引用在下一次用这个工作区之前有效
+// 乘法的结果写进草稿再和原来的矩阵交换（乒乓），不分配新矩阵；
+// 结果从第一个为1的位直接拷贝底数开始，最高位之后也不再多做一次平方
 template<typename _Td>
-Matrix<_Td> Pow(Matrix<_Td> A, size_t &b) {
+const Matrix<_Td> &Pow(const Matrix<_Td> &A, size_t b, PowWorkspace<_Td> &ws) {
     // 检查矩阵是否为方阵，如果不是则抛出异常
     if (A.RowSize() != A.ColSize()) {
         throw std::invalid_argument("The row size and column size are different.");
     }
-    // 创建一个单位矩阵，用于存储结果
-    Matrix<_Td> result = I<_Td>(A.ColSize());
-    // 使用快速幂算法计算矩阵的幂
-    while (b > 0) {
+    const size_t n = A.RowSize();
+    if (b == 0) {
+        ws.result.Assign(n, n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            ws.result[i][i] = static_cast<_Td>(1);
+        }
+        return ws.result;
+    }
+    ws.base = A;
+    bool started = false;
+    while (true) {
         if (b & static_cast<size_t>(1)) {
-            result = result * A;
+            if (!started) {
+                ws.result = ws.base;
+                started = true;
+            } else {
+                Multiply(ws.result, ws.base, ws.scratch);
+                std::swap(ws.result, ws.scratch);
+            }
         }
-        A = A * A;
         b = b >> static_cast<size_t>(1);
+        if (b == 0) {
+            break;
+        }
+        Multiply(ws.base, ws.base, ws.scratch);
+        std::swap(ws.base, ws.scratch);
     }
-    return result;
+    return ws.result;
+}
+
+// 矩阵幂运算函数，算完 b 变成 0；结果直接从临时工作区移动出来，不再多拷贝一次
+template<typename _Td>
+Matrix<_Td> Pow(const Matrix<_Td> &A, size_t &b) {
+    PowWorkspace<_Td> ws;
+    Pow(A, b, ws);
+    b = 0;
+    return ws.TakeResult();
+}
+
+// 表达式的幂，先算成矩阵
+template<typename E>
+Matrix<typename E::value_type> Pow(const MatrixExpression<E> &A, size_t &b) {
+    return Pow(Matrix<typename E::value_type>(A), b);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef SJTU_CLOCK_LRU_HPP
+#define SJTU_CLOCK_LRU_HPP
+
+#include <optional>
+#include <vector>
+
+#include "lru.hpp"
+
+/**
+    CLOCK（second chance）淘汰的缓存，接口同lru
+        sjtu :: clock_lru < Key , Value , Hash , Equal >
+    元素放在一个大小为容量的环形槽数组里，每个槽带一个访问位。
+    命中只把访问位置为1（已经是1就不写），不调整任何链表，命中路径基本只读。
+    淘汰时指针从当前位置往后扫：访问位为1的清零给第二次机会，遇到为0的就淘汰。
+    键到槽下标的索引用开放寻址的hashmap。
+*/
+
+namespace sjtu {
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class clock_lru {
+        using value_type = sjtu::pair<const Key, Value>;
+
+        //一个槽，item为空表示还没放过元素
+        struct slot {
+            std::optional<value_type> item;
+            bool referenced = false; //访问位
+        };
+
+        size_t capacity;
+        size_t size_; //已经用掉的槽数，满了之后不再变
+        size_t hand; //时钟指针，指向下一个要检查的槽
+        std::vector<slot> slots;
+        hashmap<Key, size_t, KeyHash, KeyEqual, flat_buckets> index; //键到槽下标
+
+        //扫一圈找要淘汰的槽：访问位为1的清零跳过，为0的就是它
+        size_t sweep() {
+            while (slots[hand].referenced) {
+                slots[hand].referenced = false;
+                hand = (hand + 1) % capacity;
+            }
+            size_t victim = hand;
+            hand = (hand + 1) % capacity;
+            return victim;
+        }
+
+    public:
+        clock_lru(int size) : capacity(size), size_(0), hand(0), slots(capacity) {
+        }
+
+        //插入：已有则更新值并置访问位；没满就放进下一个空槽，满了就转指针淘汰一个
+        void save(const value_type &v) {
+            auto it = index.find(v.first);
+            if (it != index.end()) {
+                slot &s = slots[it->second];
+                s.item->second = v.second;
+                s.referenced = true;
+                return;
+            }
+            if (capacity == 0) {
+                return;
+            }
+            size_t target;
+            if (size_ < capacity) {
+                target = size_++;
+            } else {
+                target = sweep();
+                index.remove(slots[target].item->first);
+            }
+            slots[target].item.emplace(v);
+            slots[target].referenced = false;
+            index.insert(pair<const Key, size_t>(v.first, target));
+        }
+
+        //命中只置访问位，返回的指针在该元素被淘汰前一直有效
+        Value *get(const Key &v) {
+            auto it = index.find(v);
+            if (it == index.end()) {
+                return nullptr;
+            }
+            slot &s = slots[it->second];
+            if (!s.referenced) {
+                s.referenced = true;
+            }
+            return &s.item->second;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        //从时钟指针开始转一圈输出，大致是从最该淘汰的到最不该淘汰的
+        void print() {
+            for (size_t i = 0; i < size_; ++i) {
+                const slot &s = slots[(hand + i) % size_];
+                std::cout << s.item->first << " " << s.item->second << std::endl;
+            }
+        }
+    };
+}
+
+#endif
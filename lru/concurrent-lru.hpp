@@ -0,0 +1,536 @@
+#ifndef SJTU_CONCURRENT_LRU_HPP
+#define SJTU_CONCURRENT_LRU_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "lru.hpp"
+
+/**
+    分片加锁的线程安全lru
+        sjtu :: concurrent_lru < Key , Value , Hash , Equal >
+    按哈希值把键分到若干分片，每个分片是一个独立加锁的lru，总容量平分给各分片。
+    不同分片上的操作互不阻塞。
+    get通过拷贝返回值：锁一释放，节点就可能被别的线程淘汰，不能把指针交出去。
+    get_or_load未命中时同一个键只加载一次：第一个未命中的线程在锁外调用loader，
+    其他线程在这次加载上等待，拿到同一个结果（或同一个异常）。
+
+    读路径不加锁的lru
+        sjtu :: read_buffered_lru < Key , Value , Hash , Equal >
+    命中只读一张开放寻址的原子指针索引，不拿锁；对共享数据只读不写，只写本线程自己的读者槽。
+    读者槽共64个，线程第一次get时占一个，线程退出时归还；同时在读的线程超过64个时，多出来的走加锁的路径。
+    命中后要做的“移到最近使用端”先记在本线程的环形缓冲区里，
+    由拿到锁的线程（save，或缓冲区快满时try_lock成功的读者）批量应用到linked_hashmap的顺序上。
+    缓冲区满了就丢掉这次记录，顺序只是近似的LRU。
+    元素和索引表被替换后不立刻释放，按epoch回收：等所有可能还在读它的读者都离开后再delete。
+*/
+
+namespace sjtu {
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class concurrent_lru {
+        using value_type = sjtu::pair<const Key, Value>;
+
+        //一次正在进行的加载，等待的线程持有shared_ptr，加载者完成后唤醒它们
+        //下面的成员都由所在分片的锁保护
+        struct flight {
+            std::condition_variable done;
+            bool finished = false;
+            int waiters = 0; //在等这次加载的线程数，没有时不用给它们留一份结果
+            std::optional<Value> value;
+            std::exception_ptr error;
+        };
+
+        //一个分片，按缓存行对齐，避免相邻分片的锁伪共享
+        struct alignas(64) shard {
+            std::mutex lock;
+            lru<Key, Value, KeyHash, KeyEqual> cache;
+            linked_hashmap<Key, std::shared_ptr<flight>, KeyHash, KeyEqual> loading; //正在加载的键
+
+            explicit shard(int size) : cache(size) {
+            }
+        };
+
+        size_t capacity_;
+        std::vector<std::unique_ptr<shard> > shards;
+
+        //选分片用打散后哈希值的高位，分片内的linked_hashmap用的是低位，两者互不干扰
+        size_t shard_of(const Key &key) const {
+            size_t h = static_cast<size_t>(KeyHash{}(key)) * 0x9E3779B97F4A7C15ull;
+            return (h >> 32) % shards.size();
+        }
+
+    public:
+        //容量平分给各分片，余数给前面的分片，所以各分片容量之和正好是size
+        //分片数不超过容量，否则会有容量为0的分片，分到它上面的键存进去就被淘汰
+        concurrent_lru(int size, size_t shard_count = 16) : capacity_(size) {
+            if (shard_count == 0) {
+                throw std::invalid_argument("shard count must be positive");
+            }
+            shard_count = std::min(shard_count, std::max<size_t>(capacity_, 1));
+            for (size_t i = 0; i < shard_count; ++i) {
+                size_t part = capacity_ / shard_count + (i < capacity_ % shard_count ? 1 : 0);
+                shards.push_back(std::make_unique<shard>(static_cast<int>(part)));
+            }
+        }
+
+        concurrent_lru(const concurrent_lru &) = delete;
+
+        concurrent_lru &operator=(const concurrent_lru &) = delete;
+
+        void save(const value_type &v) {
+            shard &s = *shards[shard_of(v.first)];
+            std::lock_guard<std::mutex> guard(s.lock);
+            s.cache.save(v);
+        }
+
+        //命中时把值拷贝到out并返回true
+        bool get(const Key &key, Value &out) {
+            shard &s = *shards[shard_of(key)];
+            std::lock_guard<std::mutex> guard(s.lock);
+            Value *value = s.cache.get(key);
+            if (value == nullptr) {
+                return false;
+            }
+            out = *value;
+            return true;
+        }
+
+        //命中时拷贝返回；未命中时同一个键只有一个线程调用loader(key)，
+        //其余线程等它完成后拿到同样的值。加载结果按普通save放进分片，参与正常的淘汰顺序
+        //loader在锁外运行，抛出的异常会传给所有在等这个键的线程，什么都不存
+        template<class Loader>
+        Value get_or_load(const Key &key, Loader &&loader) {
+            shard &s = *shards[shard_of(key)];
+            std::unique_lock<std::mutex> guard(s.lock);
+            while (true) {
+                Value *value = s.cache.get(key);
+                if (value != nullptr) {
+                    return *value;
+                }
+                auto it = s.loading.find(key);
+                if (it == s.loading.end()) {
+                    break;
+                }
+                // 已经有线程在加载，等它的结果
+                std::shared_ptr<flight> f = it->second;
+                ++f->waiters;
+                f->done.wait(guard, [&f] { return f->finished; });
+                if (f->error) {
+                    std::rethrow_exception(f->error);
+                }
+                if (f->value) {
+                    return *f->value;
+                }
+                // 加载成功但结果没能交过来（拷贝时出错），回到开头重新查
+            }
+            auto f = std::make_shared<flight>();
+            s.loading.insert({key, f});
+            guard.unlock();
+            std::optional<Value> result;
+            try {
+                result.emplace(loader(key));
+            } catch (...) {
+                f->error = std::current_exception();
+            }
+            guard.lock();
+            // 无论成败都要摘掉这次加载并唤醒等待者，否则它们会一直等下去
+            s.loading.remove(s.loading.find(key));
+            try {
+                if (result) {
+                    s.cache.save(value_type(key, *result));
+                    if (f->waiters > 0) {
+                        f->value = *result;
+                    }
+                }
+            } catch (...) {
+                f->finished = true;
+                f->done.notify_all();
+                throw;
+            }
+            f->finished = true;
+            f->done.notify_all();
+            guard.unlock();
+            if (f->error) {
+                std::rethrow_exception(f->error);
+            }
+            return std::move(*result);
+        }
+
+        //各分片元素个数之和，逐个分片加锁，所以只是某一时刻附近的近似值
+        size_t size() const {
+            size_t total = 0;
+            for (auto &s: shards) {
+                std::lock_guard<std::mutex> guard(s->lock);
+                total += s->cache.size();
+            }
+            return total;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        size_t shard_count() const {
+            return shards.size();
+        }
+
+        //按分片顺序输出，分片内从旧到新
+        void print() {
+            for (auto &s: shards) {
+                std::lock_guard<std::mutex> guard(s->lock);
+                s->cache.print();
+            }
+        }
+    };
+
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class read_buffered_lru {
+        using value_type = sjtu::pair<const Key, Value>;
+
+        //一个缓存项，发布到索引后不再修改；同一个键再次save时换成新的entry
+        struct entry {
+            Key key;
+            Value value;
+            size_t hash;
+        };
+
+        //只读索引：线性探测的原子指针数组，槽数固定为2的幂，且至少是容量的两倍
+        //删除时放墓碑，墓碑太多时整张表重建后替换
+        struct table {
+            size_t mask;
+            std::unique_ptr<std::atomic<entry *>[]> slots;
+            size_t used; //非空的槽数，含墓碑，只有持锁的线程读写
+
+            explicit table(size_t n) : mask(n - 1), slots(new std::atomic<entry *>[n]()), used(0) {
+            }
+        };
+
+        static constexpr size_t READERS = 64; //读者槽的个数，线程更多时多出来的线程走加锁的路径
+        static constexpr size_t RING = 64; //每个读者的环形缓冲区大小
+
+        //读者槽，每个线程独占一个，按缓存行对齐；线程退出时归还，见reader_lease
+        //active是读者进入时看到的epoch，不在读时为0；ring只由本线程写入，由持锁的线程消费
+        struct alignas(64) reader {
+            std::atomic<std::thread::id> owner;
+            std::atomic<uint64_t> active{0};
+            std::atomic<size_t> head{0};
+            std::atomic<entry *> ring[RING];
+            alignas(64) std::atomic<size_t> tail{0}; //消费端写，和读者写的部分分开放
+        };
+
+        //一个线程占用的所有读者槽，线程退出时在析构函数里归还，让之后的新线程还能走不加锁的路径
+        //缓存可能先于线程销毁，所以只持有读者数组的weak_ptr，数组已经不在了就什么都不做
+        struct reader_lease {
+            std::vector<pair<std::weak_ptr<reader[]>, reader *> > held;
+
+            ~reader_lease() {
+                for (auto &item: held) {
+                    if (auto alive = item.first.lock()) {
+                        // release：本线程之前对ring和head的写入对下一个占用者可见
+                        item.second->owner.store(std::thread::id(), std::memory_order_release);
+                    }
+                }
+            }
+        };
+
+        //读的时候在读者槽上登记epoch，离开时清零，异常时也要清零
+        struct read_guard {
+            reader *r;
+
+            read_guard(reader *r, uint64_t epoch) : r(r) {
+                r->active.store(epoch, std::memory_order_seq_cst);
+            }
+
+            ~read_guard() {
+                r->active.store(0, std::memory_order_release);
+            }
+        };
+
+        size_t capacity_;
+        std::mutex lock; //保护order、索引的修改、回收列表和缓冲区的消费
+        linked_hashmap<Key, entry *, KeyHash, KeyEqual> order; //最近使用顺序，值是当前的entry
+        std::atomic<table *> index;
+        std::atomic<uint64_t> epoch{1};
+        std::atomic<size_t> count{0};
+        std::shared_ptr<reader[]> readers; //线程的reader_lease持有它的weak_ptr
+        std::vector<pair<uint64_t, entry *> > retired_entries; //等待回收的entry和它被摘下时的epoch
+        std::vector<pair<uint64_t, table *> > retired_tables;
+
+        //墓碑，只比较地址，从不解引用
+        static entry *tombstone() {
+            static char mark;
+            return reinterpret_cast<entry *>(&mark);
+        }
+
+        //找到本线程的读者槽，没有就占一个空槽并记到本线程的reader_lease里；全部被占时返回nullptr
+        reader *local_reader() {
+            std::thread::id me = std::this_thread::get_id();
+            size_t start = std::hash<std::thread::id>{}(me) % READERS;
+            for (size_t i = 0; i < READERS; ++i) {
+                reader &r = readers[(start + i) % READERS];
+                std::thread::id owner = r.owner.load(std::memory_order_relaxed);
+                if (owner == me) {
+                    return &r;
+                }
+                // acquire：和上一个占用者归还时的release配对
+                if (owner == std::thread::id() &&
+                    r.owner.compare_exchange_strong(owner, me, std::memory_order_acquire)) {
+                    static thread_local reader_lease lease;
+                    std::erase_if(lease.held, [](auto &item) { return item.first.expired(); });
+                    lease.held.push_back({readers, &r});
+                    return &r;
+                }
+            }
+            return nullptr;
+        }
+
+        //读者在索引里找键，返回读到的entry，找不到返回nullptr
+        //槽随时可能被改写，所以要用这一次读到的指针，不能之后按下标再读
+        static entry *lookup(const table *t, const Key &key, size_t h) {
+            for (size_t i = h & t->mask;; i = (i + 1) & t->mask) {
+                entry *e = t->slots[i].load(std::memory_order_seq_cst);
+                if (e == nullptr) {
+                    return nullptr;
+                }
+                if (e != tombstone() && e->hash == h && KeyEqual{}(e->key, key)) {
+                    return e;
+                }
+            }
+        }
+
+        //持锁的线程找键所在槽的下标，键一定在表中
+        static size_t locate(const table *t, const Key &key, size_t h) {
+            for (size_t i = h & t->mask;; i = (i + 1) & t->mask) {
+                entry *e = t->slots[i].load(std::memory_order_relaxed);
+                if (e != tombstone() && e->hash == h && KeyEqual{}(e->key, key)) {
+                    return i;
+                }
+            }
+        }
+
+        //把元素或表挂到回收列表上，记下摘下时的epoch，并推进epoch
+        void retire(entry *e) {
+            retired_entries.push_back({epoch.fetch_add(1, std::memory_order_seq_cst), e});
+        }
+
+        void retire(table *t) {
+            retired_tables.push_back({epoch.fetch_add(1, std::memory_order_seq_cst), t});
+        }
+
+        //新表里放入一个不在表中的元素，只有持锁的线程调用
+        static void place(table *t, entry *e) {
+            size_t i = e->hash & t->mask;
+            while (true) {
+                entry *cur = t->slots[i].load(std::memory_order_relaxed);
+                if (cur == nullptr || cur == tombstone()) {
+                    break;
+                }
+                i = (i + 1) & t->mask;
+            }
+            if (t->slots[i].load(std::memory_order_relaxed) == nullptr) {
+                ++t->used;
+            }
+            t->slots[i].store(e, std::memory_order_seq_cst);
+        }
+
+        //墓碑太多时重建索引，旧表等读者离开后回收
+        void rebuild_if_needed() {
+            table *t = index.load(std::memory_order_relaxed);
+            if ((t->used + 1) * 4 <= (t->mask + 1) * 3) {
+                return;
+            }
+            table *fresh = new table(t->mask + 1);
+            for (auto it = order.begin(); it != order.end(); ++it) {
+                place(fresh, it->second);
+            }
+            index.store(fresh, std::memory_order_seq_cst);
+            retire(t);
+        }
+
+        //维护：先看哪些待回收的东西已经没有读者，再消费所有缓冲区，最后释放
+        //顺序不能换：能回收的元素，记录过它的读者都已离开，它们写进缓冲区的记录在这次消费时一定可见
+        void maintain() {
+            uint64_t oldest = UINT64_MAX;
+            for (size_t i = 0; i < READERS; ++i) {
+                uint64_t active = readers[i].active.load(std::memory_order_seq_cst);
+                if (active != 0 && active < oldest) {
+                    oldest = active;
+                }
+            }
+            for (size_t i = 0; i < READERS; ++i) {
+                reader &r = readers[i];
+                size_t head = r.head.load(std::memory_order_acquire);
+                size_t tail = r.tail.load(std::memory_order_relaxed);
+                for (; tail != head; ++tail) {
+                    entry *e = r.ring[tail % RING].load(std::memory_order_relaxed);
+                    auto it = order.find(e->key);
+                    if (it != order.end() && it->second == e) {
+                        order.touch(it);
+                    }
+                }
+                r.tail.store(tail, std::memory_order_release);
+            }
+            size_t kept = 0;
+            for (auto &item: retired_entries) {
+                if (item.first < oldest) {
+                    delete item.second;
+                } else {
+                    retired_entries[kept++] = item;
+                }
+            }
+            retired_entries.resize(kept);
+            kept = 0;
+            for (auto &item: retired_tables) {
+                if (item.first < oldest) {
+                    delete item.second;
+                } else {
+                    retired_tables[kept++] = item;
+                }
+            }
+            retired_tables.resize(kept);
+        }
+
+        //读者槽用完时的退路：加锁查找并直接调整顺序
+        bool locked_get(const Key &key, Value &out) {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = order.find(key);
+            if (it == order.end()) {
+                return false;
+            }
+            order.touch(it);
+            out = it->second->value;
+            return true;
+        }
+
+    public:
+        read_buffered_lru(int size) : capacity_(size), readers(new reader[READERS]) {
+            size_t n = 16;
+            while (n < 2 * (capacity_ + 1)) {
+                n *= 2;
+            }
+            index.store(new table(n));
+        }
+
+        read_buffered_lru(const read_buffered_lru &) = delete;
+
+        read_buffered_lru &operator=(const read_buffered_lru &) = delete;
+
+        //析构时不应再有其他线程在使用
+        ~read_buffered_lru() {
+            for (auto it = order.begin(); it != order.end(); ++it) {
+                delete it->second;
+            }
+            for (auto &item: retired_entries) {
+                delete item.second;
+            }
+            for (auto &item: retired_tables) {
+                delete item.second;
+            }
+            delete index.load();
+        }
+
+        //插入或替换，拿锁；顺便消费缓冲区、回收没人读的旧数据
+        void save(const value_type &v) {
+            std::lock_guard<std::mutex> guard(lock);
+            maintain();
+            size_t h = KeyHash{}(v.first);
+            entry *e = new entry{v.first, v.second, h};
+            table *t = index.load(std::memory_order_relaxed);
+            auto it = order.find(v.first);
+            if (it != order.end()) {
+                // 键已存在，原槽换成新的entry，旧的等读者离开后回收
+                t->slots[locate(t, v.first, h)].store(e, std::memory_order_seq_cst);
+                retire(it->second);
+                order.insert({v.first, e});
+                return;
+            }
+            rebuild_if_needed();
+            t = index.load(std::memory_order_relaxed);
+            place(t, e);
+            order.insert({v.first, e});
+            if (order.size() > capacity_) {
+                auto victim = order.begin();
+                entry *old = victim->second;
+                t->slots[locate(t, old->key, old->hash)].store(tombstone(), std::memory_order_seq_cst);
+                order.remove(victim);
+                retire(old);
+            }
+            count.store(order.size(), std::memory_order_relaxed);
+        }
+
+        //命中时把值拷贝到out并返回true；不拿锁，只有缓冲区快满时才try_lock帮忙消费
+        bool get(const Key &key, Value &out) {
+            reader *r = local_reader();
+            if (r == nullptr) {
+                return locked_get(key, out);
+            }
+            bool hit = false;
+            size_t pending;
+            {
+                read_guard guard(r, epoch.load(std::memory_order_seq_cst));
+                size_t h = KeyHash{}(key);
+                table *t = index.load(std::memory_order_seq_cst);
+                entry *e = lookup(t, key, h);
+                if (e != nullptr) {
+                    out = e->value;
+                    hit = true;
+                    // 记下这次命中，缓冲区满了就丢掉
+                    size_t head = r->head.load(std::memory_order_relaxed);
+                    if (head - r->tail.load(std::memory_order_acquire) < RING) {
+                        r->ring[head % RING].store(e, std::memory_order_relaxed);
+                        r->head.store(head + 1, std::memory_order_release);
+                    }
+                }
+                pending = r->head.load(std::memory_order_relaxed) - r->tail.load(std::memory_order_relaxed);
+            }
+            if (pending >= RING / 2 && lock.try_lock()) {
+                maintain();
+                lock.unlock();
+            }
+            return hit;
+        }
+
+        size_t size() const {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        //当前被线程占用的读者槽个数，线程退出后它的槽会被归还
+        size_t active_readers() const {
+            size_t used = 0;
+            for (size_t i = 0; i < READERS; ++i) {
+                used += readers[i].owner.load(std::memory_order_relaxed) != std::thread::id();
+            }
+            return used;
+        }
+
+        //先把缓冲区里的命中应用到顺序上，再从旧到新输出
+        void print() {
+            std::lock_guard<std::mutex> guard(lock);
+            maintain();
+            for (auto it = order.begin(); it != order.end(); ++it) {
+                std::cout << it->first << " " << it->second->value << std::endl;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef SJTU_EXPIRING_LRU_HPP
+#define SJTU_EXPIRING_LRU_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+
+#include "lru.hpp"
+
+/**
+    带过期时间（TTL）的lru
+        sjtu :: expiring_lru < Key , Value , Hash , Equal , Clock >
+    after_write：元素在最后一次save之后ttl到期；after_access：最后一次save或get命中之后ttl到期。
+    到期时间按tick（默认1毫秒）计，挂在一个4层、每层64格的分层时间轮上：
+    第l层的一格管64^l个tick，到了这一格就把里面的元素重新分到下面的层（cascade），第0层到格即到期。
+    每个元素只会往下移最多3次，所以到期处理均摊O(1)，不用扫整个insert_list。
+    get只检查自己这个元素是否到期（惰性），save时才把时间轮推进到当前时刻，批量删除到期的元素。
+    时间轮的链表指针直接放在linked_hashmap的节点里，不另外分配。
+    Clock可以换成测试用的假时钟，只需要提供now()、duration和time_point。
+*/
+
+namespace sjtu {
+    enum class expire_policy {
+        after_write,
+        after_access
+    };
+
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal,
+        class Clock = std::chrono::steady_clock>
+    class expiring_lru {
+        struct timed_value;
+        using lmap = sjtu::linked_hashmap<Key, timed_value, KeyHash, KeyEqual>;
+        using node_type = LinkedNode<pair<const Key, timed_value> >;
+        using value_type = sjtu::pair<const Key, Value>;
+        using duration = typename Clock::duration;
+
+        //值、到期的tick，以及它在时间轮某一格的双向链表里的位置
+        struct timed_value {
+            Value value;
+            uint64_t deadline;
+            node_type *wheel_prev = nullptr;
+            node_type *wheel_next = nullptr;
+            int level = 0;
+            int slot = 0;
+        };
+
+        static constexpr int LEVELS = 4; //时间轮的层数
+        static constexpr int SLOT_BITS = 6; //每层64格
+        static constexpr int SLOTS = 1 << SLOT_BITS;
+
+        size_t capacity;
+        duration ttl;
+        duration resolution; //一个tick的长度
+        expire_policy policy;
+        typename Clock::time_point start; //tick 0对应的时刻
+        lmap memory;
+        node_type *wheel[LEVELS][SLOTS] = {}; //每一格的链表头
+        size_t level_count[LEVELS] = {}; //每层挂着的元素个数，用来跳过空的层
+        uint64_t now_tick; //时间轮已经处理到的tick
+
+        uint64_t current_tick() const {
+            return static_cast<uint64_t>((Clock::now() - start) / resolution);
+        }
+
+        //从现在起ttl之后的tick，向上取整，宁可晚到期一点也不提前
+        uint64_t deadline_from_now() const {
+            duration end = (Clock::now() - start) + ttl;
+            uint64_t tick = static_cast<uint64_t>(end / resolution);
+            return end % resolution == duration::zero() ? tick : tick + 1;
+        }
+
+        void link(node_type *node, int level, int slot) {
+            timed_value &t = node->data.second;
+            t.level = level;
+            t.slot = slot;
+            t.wheel_prev = nullptr;
+            t.wheel_next = wheel[level][slot];
+            if (t.wheel_next != nullptr) {
+                t.wheel_next->data.second.wheel_prev = node;
+            }
+            wheel[level][slot] = node;
+            ++level_count[level];
+        }
+
+        void unlink(node_type *node) {
+            timed_value &t = node->data.second;
+            if (t.wheel_prev != nullptr) {
+                t.wheel_prev->data.second.wheel_next = t.wheel_next;
+            } else {
+                wheel[t.level][t.slot] = t.wheel_next;
+            }
+            if (t.wheel_next != nullptr) {
+                t.wheel_next->data.second.wheel_prev = t.wheel_prev;
+            }
+            t.wheel_prev = t.wheel_next = nullptr;
+            --level_count[t.level];
+        }
+
+        //按到期时间挂到合适的层：和下一个要处理的tick在第l层以上的位都相同，就放第l层
+        //比最高层能表示的还远的，先挂在这一圈的最后一个tick上，到时候再重新分
+        void schedule(node_type *node) {
+            uint64_t base = now_tick + 1;
+            uint64_t span_end = (((base >> (SLOT_BITS * LEVELS)) + 1) << (SLOT_BITS * LEVELS)) - 1;
+            uint64_t d = std::min(std::max(node->data.second.deadline, base), span_end);
+            int level = 0;
+            while ((d >> (SLOT_BITS * (level + 1))) != (base >> (SLOT_BITS * (level + 1)))) {
+                ++level;
+            }
+            link(node, level, static_cast<int>((d >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        //摘下一整格的链表
+        node_type *detach(int level, int slot) {
+            node_type *head = wheel[level][slot];
+            wheel[level][slot] = nullptr;
+            for (node_type *node = head; node != nullptr; node = node->data.second.wheel_next) {
+                --level_count[level];
+            }
+            return head;
+        }
+
+        //处理tick t：先把到点的高层格子往下分，再处理第0层这一格，到期的删除
+        void process(uint64_t t) {
+            now_tick = t - 1;
+            for (int level = LEVELS - 1; level > 0; --level) {
+                if ((t & ((1ull << (SLOT_BITS * level)) - 1)) == 0) {
+                    node_type *node = detach(level, static_cast<int>((t >> (SLOT_BITS * level)) & (SLOTS - 1)));
+                    while (node != nullptr) {
+                        node_type *next = node->data.second.wheel_next;
+                        schedule(node);
+                        node = next;
+                    }
+                }
+            }
+            now_tick = t;
+            node_type *node = detach(0, static_cast<int>(t & (SLOTS - 1)));
+            while (node != nullptr) {
+                node_type *next = node->data.second.wheel_next;
+                if (node->data.second.deadline <= t) {
+                    memory.remove(typename lmap::iterator(node, &memory));
+                } else {
+                    schedule(node);
+                }
+                node = next;
+            }
+        }
+
+        //把时间轮推进到target；下面几层都空的时候直接跳到下一个需要往下分的tick
+        void advance(uint64_t target) {
+            while (now_tick < target) {
+                uint64_t t = now_tick + 1;
+                int empty = 0;
+                while (empty < LEVELS && level_count[empty] == 0) {
+                    ++empty;
+                }
+                if (empty == LEVELS) {
+                    now_tick = target;
+                    break;
+                }
+                uint64_t span = 1ull << (SLOT_BITS * empty);
+                if (empty > 0 && (t & (span - 1)) != 0) {
+                    now_tick = std::min(target, ((t >> (SLOT_BITS * empty)) + 1) * span - 1);
+                    continue;
+                }
+                process(t);
+            }
+        }
+
+        //淘汰或过期删除前先从时间轮上摘下
+        void erase(typename lmap::iterator it) {
+            unlink(it.current);
+            memory.remove(it);
+        }
+
+        //拷贝memory后节点里的时间轮指针还指向原对象的节点，清空时间轮，按到期时间把每个节点重新挂一遍
+        void rebuild_wheel() {
+            for (auto &level: wheel) {
+                std::fill(std::begin(level), std::end(level), nullptr);
+            }
+            std::fill(std::begin(level_count), std::end(level_count), 0);
+            for (auto it = memory.begin(); it != memory.end(); ++it) {
+                schedule(it.current);
+            }
+        }
+
+    public:
+        expiring_lru(int size, duration ttl, expire_policy policy = expire_policy::after_write,
+                     duration resolution = std::chrono::milliseconds(1))
+            : capacity(size), ttl(ttl), resolution(resolution), policy(policy), start(Clock::now()), now_tick(0) {
+        }
+
+        //深拷贝：元素和到期时间原样复制，时间轮在副本里重建，不和原对象共享节点
+        expiring_lru(const expiring_lru &other)
+            : capacity(other.capacity), ttl(other.ttl), resolution(other.resolution), policy(other.policy),
+              start(other.start), memory(other.memory), now_tick(other.now_tick) {
+            rebuild_wheel();
+        }
+
+        expiring_lru &operator=(const expiring_lru &other) {
+            if (this != &other) {
+                capacity = other.capacity;
+                ttl = other.ttl;
+                resolution = other.resolution;
+                policy = other.policy;
+                start = other.start;
+                memory = other.memory;
+                now_tick = other.now_tick;
+                rebuild_wheel();
+            }
+            return *this;
+        }
+
+        //先批量删除已经到期的元素，再插入或更新；写入总会重新计算到期时间
+        void save(const value_type &v) {
+            advance(current_tick());
+            auto it = memory.find(v.first);
+            if (it != memory.end()) {
+                unlink(it.current);
+                it->second.value = v.second;
+                it->second.deadline = deadline_from_now();
+                memory.touch(it);
+                schedule(it.current);
+                return;
+            }
+            auto result = memory.insert(pair<const Key, timed_value>(v.first, timed_value{v.second, deadline_from_now()}));
+            schedule(result.first.current);
+            if (memory.size() > capacity) {
+                erase(memory.begin());
+            }
+        }
+
+        //命中时先看自己是否到期，到期就当场删掉；after_access模式下命中会推迟到期时间
+        Value *get(const Key &v) {
+            auto it = memory.find(v);
+            if (it == memory.end()) {
+                return nullptr;
+            }
+            if (current_tick() >= it->second.deadline) {
+                erase(it);
+                return nullptr;
+            }
+            memory.touch(it);
+            if (policy == expire_policy::after_access) {
+                unlink(it.current);
+                it->second.deadline = deadline_from_now();
+                schedule(it.current);
+            }
+            return &(it->second.value);
+        }
+
+        //把时间轮推进到当前时刻，删除所有到期的元素
+        void cleanup() {
+            advance(current_tick());
+        }
+
+        //包括已经到期但还没被删除的元素
+        size_t size() const {
+            return memory.size();
+        }
+
+        void print() {
+            cleanup();
+            for (auto it = memory.begin(); it != memory.end(); ++it) {
+                std::cout << (*it).first << " " << (*it).second.value << std::endl;
+            }
+        }
+    };
+}
+
+#endif
@@ -1,6 +1,18 @@
 #ifndef SJTU_LRU_HPP
 #define SJTU_LRU_HPP
 #include <ranges>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "utility.hpp"
 #include "exceptions.hpp"
@@ -12,11 +24,13 @@
     包含
         sjtu :: double_list <T >
         sjtu :: hashmap < Key ,T , Hash , Equal >
+        sjtu :: hashmap < Key ,T , Hash , Equal , flat_buckets >
+            // 开放寻址的存储方式，接口相同
         sjtu :: linked_hashmap < Key ,T , Hash , Equal >
-            // derived from sjtu :: hashmap < Key ,T , Hash , Equal >
-        sjtu :: lru
-        linked hashmap是派生类
-    模板类的派生类在调用基类函数时，需要指定this
+        sjtu :: lru < Key , Value , Hash , Equal >
+            // 默认参数为 < Integer , Matrix < int > , Hash , Equal >
+    linked hashmap的每个元素只存一份，放在一个LinkedNode里，
+    这个节点同时挂在哈希桶的单链和插入顺序的双向链表上，find一次哈希即可找到。
     double list包含实现linked hashmap所需要的双向链表的接口。
     自行实现链表，你可以自己新定义一些类来辅助实现。
     lru没有默认构造函数，构造时必须给定size参数。
@@ -24,10 +38,16 @@
 
 
 //hash接口
+//带is_transparent，可以直接用int查找，不用构造Integer临时对象
 class Hash {
 public:
-    unsigned int operator ()(Integer lhs) const {
-        int val = lhs.val;
+    using is_transparent = void;
+
+    unsigned int operator ()(const Integer &lhs) const {
+        return (*this)(lhs.val);
+    }
+
+    unsigned int operator ()(int val) const {
         return std::hash<int>()(val);
     }
 };
@@ -35,12 +55,42 @@ public:
 //equal接口
 class Equal {
 public:
+    using is_transparent = void;
+
     bool operator ()(const Integer &lhs, const Integer &rhs) const {
         return lhs.val == rhs.val;
     }
+
+    bool operator ()(const Integer &lhs, int rhs) const {
+        return lhs.val == rhs;
+    }
+
+    bool operator ()(int lhs, const Integer &rhs) const {
+        return lhs == rhs.val;
+    }
 };
 
 namespace sjtu {
+    //Hash和Equal都带is_transparent时，查找类接口接受任何能与Key比较的类型（如int、std::string_view），
+    //查找路径上不构造Key
+    template<class Hash, class Equal>
+    concept transparent_lookup = requires {
+        typename Hash::is_transparent;
+        typename Equal::is_transparent;
+    };
+
+    //批量查找每次先处理这么多个键：全部算好哈希并预取，再逐个探测
+    constexpr size_t BATCH_SIZE = 16;
+
+    //提示CPU提前把p所在的缓存行读进来，只影响性能不影响语义
+    inline void prefetch(const void *p) {
+#if defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void) p;
+#endif
+    }
+
     //Node,包括数据，前后的指针，用于实现双向链表
     template<typename T>
     class Node {
@@ -49,18 +99,232 @@ namespace sjtu {
         Node *prev;
         Node *next;
 
-        explicit Node(T data): data(data), prev(nullptr), next(nullptr) {
+        //参数直接转发给data的构造函数
+        template<class... Args>
+        explicit Node(std::in_place_t, Args &&... args)
+            : data(std::forward<Args>(args)...), prev(nullptr), next(nullptr) {
+        }
+    };
+
+    //HashedNode,在Node的基础上缓存键的完整哈希值，供hashmap使用
+    //扩容搬迁时直接用缓存的值重新分桶，查找时先比哈希值，相等才调用Equal
+    template<typename T>
+    class HashedNode {
+    public:
+        T data;
+        HashedNode *prev;
+        HashedNode *next;
+        size_t hash; //键的哈希值，由hashmap在插入时填写
+
+        template<class... Args>
+        explicit HashedNode(std::in_place_t, Args &&... args)
+            : data(std::forward<Args>(args)...), prev(nullptr), next(nullptr), hash(0) {
+        }
+    };
+
+    //LinkedNode,在Node的基础上多一个桶内的后继指针和缓存的哈希值
+    //linked_hashmap的每个元素只存在于一个LinkedNode中，同时挂在哈希桶的单链和插入顺序的双向链表上
+    template<typename T>
+    class LinkedNode {
+    public:
+        T data;
+        LinkedNode *prev;
+        LinkedNode *next;
+        LinkedNode *hash_next; //同一个桶中的下一个节点
+        size_t hash; //键的哈希值，由linked_hashmap在插入时填写
+
+        template<class... Args>
+        explicit LinkedNode(std::in_place_t, Args &&... args)
+            : data(std::forward<Args>(args)...), prev(nullptr), next(nullptr), hash_next(nullptr), hash(0) {
+        }
+    };
+
+    //———————————————————————————————————————node_pool——————————————————————————————————————————————————————//
+
+    //节点池：按块批量申请节点内存，释放的节点挂到空闲链表上复用，不再每个节点new/delete一次
+    //池只管内存，节点的构造和析构由使用者负责；块的大小从16开始逐块翻倍，最多4096个节点
+    template<class NodeT>
+    class node_pool {
+    private:
+        //空闲时这块内存用来串空闲链表，使用时放一个节点
+        union slot {
+            slot *next_free;
+            alignas(NodeT) unsigned char storage[sizeof(NodeT)];
+        };
+
+        std::vector<slot *> slabs; //申请过的所有块
+        slot *free_list; //空闲链表的头
+        size_t slab_size; //下一块的节点数
+        size_t free_count; //空闲链表上的节点数
+
+        //申请n个节点的一块，按地址从小到大挂到空闲链表上
+        void grow(size_t n) {
+            slot *slab = new slot[n];
+            slabs.push_back(slab);
+            for (size_t i = n; i > 0; --i) {
+                slab[i - 1].next_free = free_list;
+                free_list = &slab[i - 1];
+            }
+            free_count += n;
+        }
+
+    public:
+        node_pool() : free_list(nullptr), slab_size(16), free_count(0) {
+        }
+
+        node_pool(const node_pool &) = delete;
+
+        node_pool &operator=(const node_pool &) = delete;
+
+        ~node_pool() {
+            release();
+        }
+
+        //取一个节点大小的未初始化内存，空闲链表为空时才申请新块
+        NodeT *allocate() {
+            if (free_list == nullptr) {
+                grow(slab_size);
+                if (slab_size < 4096) {
+                    slab_size *= 2;
+                }
+            }
+            slot *s = free_list;
+            free_list = s->next_free;
+            --free_count;
+            return reinterpret_cast<NodeT *>(s->storage);
+        }
+
+        //归还一个已经析构的节点
+        void deallocate(NodeT *node) {
+            slot *s = reinterpret_cast<slot *>(node);
+            s->next_free = free_list;
+            free_list = s;
+            ++free_count;
+        }
+
+        //取一块内存并在上面构造节点，参数转发给元素的构造函数；构造抛异常时内存还回池里
+        template<class... Args>
+        NodeT *create(Args &&... args) {
+            NodeT *node = allocate();
+            try {
+                new(node) NodeT(std::in_place, std::forward<Args>(args)...);
+            } catch (...) {
+                deallocate(node);
+                throw;
+            }
+            return node;
+        }
+
+        //析构节点并归还
+        void destroy(NodeT *node) {
+            node->~NodeT();
+            deallocate(node);
+        }
+
+        //保证接下来n次allocate都不用再申请内存，不够的部分一次申请成一整块
+        void reserve(size_t n) {
+            if (n > free_count) {
+                grow(n - free_count);
+            }
+        }
+
+        //一次性释放所有块，调用前所有节点必须已经析构或不再使用
+        void release() {
+            for (slot *slab: slabs) {
+                delete[] slab;
+            }
+            slabs.clear();
+            free_list = nullptr;
+            slab_size = 16;
+            free_count = 0;
+        }
+    };
+
+    //———————————————————————————————————————bucket_table———————————————————————————————————————————————————//
+
+    //桶表：一整块桶头指针，全部初始化为nullptr
+    //用calloc申请，大块内存由系统按页给出清零的页，新建一张大表不用逐个写入，扩容时不会卡在清零上
+    template<class NodeT>
+    class bucket_table {
+    private:
+        NodeT **heads;
+        size_t count;
+
+    public:
+        bucket_table() : heads(nullptr), count(0) {
+        }
+
+        explicit bucket_table(size_t n) : heads(nullptr), count(0) {
+            if (n != 0) {
+                heads = static_cast<NodeT **>(std::calloc(n, sizeof(NodeT *)));
+                if (heads == nullptr) {
+                    throw std::bad_alloc();
+                }
+                count = n;
+            }
+        }
+
+        bucket_table(const bucket_table &) = delete;
+
+        bucket_table &operator=(const bucket_table &) = delete;
+
+        bucket_table(bucket_table &&other) noexcept : heads(other.heads), count(other.count) {
+            other.heads = nullptr;
+            other.count = 0;
+        }
+
+        bucket_table &operator=(bucket_table &&other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~bucket_table() {
+            std::free(heads);
+        }
+
+        void swap(bucket_table &other) noexcept {
+            std::swap(heads, other.heads);
+            std::swap(count, other.count);
+        }
+
+        //把所有桶置空，桶数不变
+        void reset() {
+            std::fill(heads, heads + count, nullptr);
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        NodeT *&operator[](size_t index) {
+            return heads[index];
+        }
+
+        NodeT *operator[](size_t index) const {
+            return heads[index];
+        }
+
+        NodeT *const *begin() const {
+            return heads;
+        }
+
+        NodeT *const *end() const {
+            return heads + count;
         }
     };
 
     //———————————————————————————————————————double_list————————————————————————————————————————————————————//
 
-    //双向链表
-    template<class T>
+    //双向链表，NodeT为节点类型，默认是Node<T>
+    template<class T, class NodeT = Node<T> >
     class double_list {
     public:
-        Node<T> *head; // 指向头节点的指针
-        Node<T> *tail; // 指向尾节点的指针
+        NodeT *head; // 指向头节点的指针
+        NodeT *tail; // 指向尾节点的指针
         int size; // 链表的大小
         // --------------------------
         //默认构造函数
@@ -68,12 +332,19 @@ namespace sjtu {
         }
 
         //拷贝构造函数，不断地在尾部插入值，复杂度n
-        double_list(const double_list<T> &other) : head(nullptr), tail(nullptr), size(0) {
-            for (Node<T> *current = other.head; current != nullptr; current = current->next) {
+        double_list(const double_list &other) : head(nullptr), tail(nullptr), size(0) {
+            for (NodeT *current = other.head; current != nullptr; current = current->next) {
                 insert_tail(current->data);
             }
         }
 
+        //移动构造，直接接管节点；noexcept让vector扩容时移动而不是拷贝桶
+        double_list(double_list &&other) noexcept
+            : head(other.head), tail(other.tail), size(other.size) {
+            other.head = other.tail = nullptr;
+            other.size = 0;
+        }
+
         //清空，复杂度n
         void clear() {
             while (head != nullptr) {
@@ -82,6 +353,13 @@ namespace sjtu {
             size = 0;
         }
 
+        //只把链表置空而不逐个释放节点，用于节点不是由链表自己new出来的情况
+        //（如linked_hashmap的节点来自它的node_pool，由它负责析构和回收）
+        void forget() {
+            head = tail = nullptr;
+            size = 0;
+        }
+
         //析构，复杂度n
         ~double_list() {
             while (head != nullptr) {
@@ -89,18 +367,29 @@ namespace sjtu {
             }
         }
 
+        //新建节点，参数转发给元素的构造函数
+        template<class... Args>
+        NodeT *create_node(Args &&... args) {
+            return new NodeT(std::in_place, std::forward<Args>(args)...);
+        }
+
+        //释放节点
+        void destroy_node(NodeT *node) {
+            delete node;
+        }
+
         //内置迭代器类
         class iterator {
         public:
-            Node<T> *current; //当前指向的数据指针
-            double_list<T> *list; //所在的doublelist
+            NodeT *current; //当前指向的数据指针
+            double_list *list; //所在的doublelist
             // --------------------------
             //默认构造函数
             iterator() : current(nullptr), list(nullptr) {
             }
 
             //初始化
-            iterator(Node<T> *node, double_list<T> *lst) : current(node), list(lst) {
+            iterator(NodeT *node, double_list *lst) : current(node), list(lst) {
             }
 
             //拷贝
@@ -173,7 +462,7 @@ namespace sjtu {
 
         // const版本的begin
         iterator begin() const {
-            return iterator(head, const_cast<double_list<T> *>(this));
+            return iterator(head, const_cast<double_list *>(this));
         }
 
         // 非const版本的end
@@ -183,7 +472,7 @@ namespace sjtu {
 
         // const版本的end
         iterator end() const {
-            return iterator(nullptr, const_cast<double_list<T> *>(this));
+            return iterator(nullptr, const_cast<double_list *>(this));
         }
 
         //去掉某一个元素，注意头尾特判等
@@ -191,26 +480,64 @@ namespace sjtu {
             if (pos.current == nullptr) {
                 return pos;
             }
-            Node<T> *toDelete = pos.current;
+            NodeT *toDelete = pos.current;
             iterator nextIter(toDelete->next, this);
-            if (toDelete->prev != nullptr) {
-                toDelete->prev->next = toDelete->next;
+            unlink(toDelete);
+            destroy_node(toDelete);
+            return nextIter;
+        }
+
+        //把节点从链表中摘下，但不释放，注意头尾特判
+        void unlink(NodeT *node) {
+            if (node->prev != nullptr) {
+                node->prev->next = node->next;
             } else {
-                head = toDelete->next;
+                head = node->next;
             }
-            if (toDelete->next != nullptr) {
-                toDelete->next->prev = toDelete->prev;
+            if (node->next != nullptr) {
+                node->next->prev = node->prev;
             } else {
-                tail = toDelete->prev;
+                tail = node->prev;
             }
-            delete toDelete;
+            node->prev = node->next = nullptr;
             size--;
-            return nextIter;
+        }
+
+        //把链表中的节点移到尾部，只改指针，O(1)
+        void move_to_tail(NodeT *node) {
+            if (node == tail) {
+                return;
+            }
+            unlink(node);
+            link_tail(node);
+        }
+
+        //把一个已经分配好的节点接到尾部，不分配内存
+        void link_tail(NodeT *node) {
+            node->next = nullptr;
+            node->prev = tail;
+            if (tail == nullptr) {
+                head = node;
+            } else {
+                tail->next = node;
+            }
+            tail = node;
+            size++;
         }
 
         //在头部插入元素
         void insert_head(const T &val) {
-            auto *newNode = new Node<T>(val);
+            emplace_head(val);
+        }
+
+        void insert_head(T &&val) {
+            emplace_head(std::move(val));
+        }
+
+        //用参数在头部直接构造元素
+        template<class... Args>
+        void emplace_head(Args &&... args) {
+            auto *newNode = create_node(std::forward<Args>(args)...);
             if (head == nullptr) {
                 head = tail = newNode;
             } else {
@@ -223,7 +550,17 @@ namespace sjtu {
 
         //在尾部插入元素
         void insert_tail(const T &val) {
-            auto *newNode = new Node<T>(val);
+            emplace_tail(val);
+        }
+
+        void insert_tail(T &&val) {
+            emplace_tail(std::move(val));
+        }
+
+        //用参数在尾部直接构造元素
+        template<class... Args>
+        void emplace_tail(Args &&... args) {
+            auto *newNode = create_node(std::forward<Args>(args)...);
             if (tail == nullptr) {
                 head = tail = newNode;
             } else {
@@ -239,14 +576,14 @@ namespace sjtu {
             if (head == nullptr) {
                 return;
             }
-            Node<T> *temp = head;
+            NodeT *temp = head;
             if (head == tail) {
                 head = tail = nullptr;
             } else {
                 head = head->next;
                 head->prev = nullptr;
             }
-            delete temp;
+            destroy_node(temp);
             size--;
         }
 
@@ -255,14 +592,14 @@ namespace sjtu {
             if (tail == nullptr) {
                 return;
             }
-            Node<T> *temp = tail;
+            NodeT *temp = tail;
             if (head == tail) {
                 head = tail = nullptr;
             } else {
                 tail = tail->prev;
                 tail->next = nullptr;
             }
-            delete temp;
+            destroy_node(temp);
             size--;
         }
 
@@ -274,89 +611,645 @@ namespace sjtu {
 
     //————————————————————————————————————————hashmap————————————————————————————————————————————————————————//
 
+    //hashmap存储方式的标签，作为第五个模板参数
+    struct chained_buckets {}; //每个桶一条双向链表（默认）
+    struct flat_buckets {}; //开放寻址，所有元素放在连续的槽里，见下面的特化
+
     template<
         class Key,
         class T,
         class Hash = std::hash<Key>,
-        class Equal = std::equal_to<Key> >
+        class Equal = std::equal_to<Key>,
+        class Storage = chained_buckets>
     class hashmap {
     private:
         using value_type = pair<const Key, T>;
-        std::vector<double_list<value_type> > buckets; //用双向列表作为一个桶，有很多个桶
+        using node_type = HashedNode<value_type>; //节点里缓存了键的哈希值
+        //桶表只存每个桶的头指针，桶内的节点用prev/next串成双向链表
+        //新表就是一块清零的指针，分配和释放都不用逐个构造或析构桶
+        using table_type = bucket_table<node_type>;
+        node_pool<node_type> pool; //所有桶共用的节点池
+        table_type buckets; //当前的桶表
         size_t size_; //哈希表的大小
-        static constexpr double LOAD_FACTOR_THRESHOLD = 0.5; //负载因子
+        static constexpr double LOAD_FACTOR_THRESHOLD = 0.5; //默认的最大负载因子
+        double max_load_; //最大负载因子，超过时扩容
+
+        //渐进式扩容：扩容时旧表先留着，每次insert/remove顺手搬MIGRATE_STEP个旧桶到新表
+        //旧表中下标不小于migrate_pos的桶还没搬，哈希到这些桶的元素（包括搬迁期间新插入的）都放在旧表里，
+        //所以任何键都只在bucket_of给出的一个桶里；old_buckets为空表示没有在搬迁
+        table_type old_buckets;
+        size_t migrate_pos; //下一个要搬的旧桶
+        static constexpr size_t MIGRATE_STEP = 4; //每次操作最多搬的旧桶数
+
+        //哈希值为h的元素所在的桶
+        node_type *&bucket_of(size_t h) {
+            if (!old_buckets.empty()) {
+                size_t index = h % old_buckets.size();
+                if (index >= migrate_pos) {
+                    return old_buckets[index];
+                }
+            }
+            return buckets[h % buckets.size()];
+        }
+
+        node_type *bucket_of(size_t h) const {
+            return const_cast<hashmap *>(this)->bucket_of(h);
+        }
+
+        //在从head开始的桶里查找哈希值为h的key，找不到返回nullptr
+        //先比缓存的哈希值，相等时才调用Equal
+        template<class K>
+        static node_type *find_in(node_type *head, const K &key, size_t h) {
+            for (node_type *node = head; node != nullptr; node = node->next) {
+                if (node->hash == h && Equal{}(node->data.first, key)) {
+                    return node;
+                }
+            }
+            return nullptr;
+        }
+
+        //把节点接到桶头
+        static void link_head(node_type *&head, node_type *node) {
+            node->prev = nullptr;
+            node->next = head;
+            if (head != nullptr) {
+                head->prev = node;
+            }
+            head = node;
+        }
+
+        //把节点从桶里摘下，head为它所在的桶
+        static void unlink(node_type *&head, node_type *node) {
+            if (node->prev != nullptr) {
+                node->prev->next = node->next;
+            } else {
+                head = node->next;
+            }
+            if (node->next != nullptr) {
+                node->next->prev = node->prev;
+            }
+        }
+
+        //搬迁最多step个旧桶，节点直接从旧桶摘下接到新桶，不拷贝元素；搬完后释放旧表
+        void migrate(size_t step) {
+            while (step > 0 && !old_buckets.empty()) {
+                node_type *node = old_buckets[migrate_pos];
+                while (node != nullptr) {
+                    node_type *next = node->next;
+                    link_head(buckets[node->hash % buckets.size()], node);
+                    node = next;
+                }
+                old_buckets[migrate_pos] = nullptr;
+                if (++migrate_pos == old_buckets.size()) {
+                    table_type().swap(old_buckets);
+                }
+                --step;
+            }
+        }
 
+        //对两张表里的每个节点调用f，f可以释放节点
+        template<class F>
+        void for_each_node(F &&f) const {
+            for (auto *table: {&buckets, &old_buckets}) {
+                for (node_type *head: *table) {
+                    while (head != nullptr) {
+                        node_type *next = head->next;
+                        f(head);
+                        head = next;
+                    }
+                }
+            }
+        }
+
+        //把other的所有元素接进来，要求当前为空且桶数不少于other的当前表
+        //键互不相同，直接用缓存的哈希值分桶，不再哈希也不比较
+        //拷贝元素抛异常时析构已经拷好的元素并清空，再把异常抛出去（拷贝构造时析构函数不会执行）
+        void copy_from(const hashmap &other) {
+            try {
+                other.for_each_node([this](const node_type *node) {
+                    node_type *copy = pool.create(node->data);
+                    copy->hash = node->hash;
+                    link_head(buckets[node->hash % buckets.size()], copy);
+                    ++size_;
+                });
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
 
         // --------------------------
         //默认设置为16大小
         public:
-        hashmap() : size_(0) {
-            buckets.resize(16);
+        hashmap() : buckets(16), size_(0), max_load_(LOAD_FACTOR_THRESHOLD), migrate_pos(0) {
         }
 
         //拷贝
-        hashmap(const hashmap &other) : size_(other.size_) {
-            buckets.resize(other.buckets.size());
-            for (size_t i = 0; i < other.buckets.size(); ++i) {
-                for (auto it = other.buckets[i].begin(); it != other.buckets[i].end(); ++it) {
-                    insert(*it);
+        hashmap(const hashmap &other)
+            : buckets(other.buckets.size()), size_(0), max_load_(other.max_load_), migrate_pos(0) {
+            copy_from(other);
+        }
+
+        //析构
+        ~hashmap() {
+            clear();
+        }
+
+        //赋值运算符重载
+        hashmap &operator=(const hashmap &other) {
+            if (this != &other) {
+                clear();
+                buckets = table_type(other.buckets.size());
+                max_load_ = other.max_load_;
+                copy_from(other);
+            }
+            return *this;
+        }
+
+
+
+        //内置指针类
+        class iterator {
+        public:
+            node_type *current; //指向的节点，end为nullptr
+            const hashmap *map; //所在的哈希表
+
+            // --------------------------
+            iterator() : current(nullptr), map(nullptr) {
+            }
+
+            iterator(node_type *node, const hashmap *m) : current(node), map(m) {
+            }
+
+            iterator(const iterator &t) : current(t.current), map(t.map) {
+            }
+
+            ~iterator() {
+            }
+
+            value_type &operator*() const {
+                if (current == nullptr) {
+                    throw std::invalid_argument("Invalid iterator");
+                }
+                return current->data;
+            }
+
+            value_type *operator->() const noexcept {
+                return &(current->data);
+            }
+
+            bool operator==(const iterator &rhs) const {
+                return current == rhs.current && map == rhs.map;
+            }
+
+            bool operator!=(const iterator &rhs) const {
+                return !(*this == rhs);
+            }
+        };
+
+        //清空，最后把节点池整块释放；元素可平凡析构时不用逐个析构节点
+        void clear() {
+            if constexpr (!std::is_trivially_destructible_v<value_type>) {
+                for_each_node([this](node_type *node) { pool.destroy(node); });
+            }
+            buckets.reset();
+            table_type().swap(old_buckets);
+            migrate_pos = 0;
+            size_ = 0;
+            pool.release();
+        }
+
+        //扩容为两倍：只分配一张清零的新表，旧表留给之后的操作逐步搬迁
+        //上一轮还没搬完时先搬完（阈值0.5、步长4保证正常情况下走不到这里）
+        void expand() {
+            migrate(old_buckets.size());
+            old_buckets.swap(buckets);
+            buckets = table_type(old_buckets.size() * 2);
+            migrate_pos = 0;
+        }
+
+        //是否正在渐进式扩容
+        bool rehashing() const {
+            return !old_buckets.empty();
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        // --------------------------
+        //桶数控制：一次性重建，不走渐进式搬迁
+
+        //桶的个数（不含搬迁中的旧表）
+        size_t bucket_count() const {
+            return buckets.size();
+        }
+
+        double load_factor() const {
+            return static_cast<double>(size_) / buckets.size();
+        }
+
+        double max_load_factor() const {
+            return max_load_;
+        }
+
+        //设置最大负载因子，当前已经超过时立刻重建
+        void max_load_factor(double ml) {
+            if (!(ml > 0)) {
+                throw std::invalid_argument("max_load_factor must be positive");
+            }
+            max_load_ = ml;
+            if (load_factor() >= max_load_) {
+                rehash(0);
+            }
+        }
+
+        //重建为至少n个桶，且桶数足够让当前元素不超过最大负载因子
+        //节点直接摘下重新挂，不拷贝元素，用缓存的哈希值分桶
+        void rehash(size_t n) {
+            migrate(old_buckets.size());
+            n = std::max({n, static_cast<size_t>(size_ / max_load_) + 1, size_t(1)});
+            if (n == buckets.size()) {
+                return;
+            }
+            old_buckets.swap(buckets);
+            buckets = table_type(n);
+            migrate_pos = 0;
+            migrate(old_buckets.size());
+        }
+
+        //预留能放下n个元素而不扩容的桶，节点池也一次备好剩下的节点
+        void reserve(size_t n) {
+            if (static_cast<double>(n) / buckets.size() >= max_load_) {
+                rehash(static_cast<size_t>(n / max_load_) + 1);
+            }
+            if (n > size_) {
+                pool.reserve(n - size_);
+            }
+        }
+
+    private:
+        //查找哈希值为h的key，搬迁期间也只需查一个桶
+        template<class K>
+        iterator find_hashed(const K &key, size_t h) const {
+            return iterator(find_in(bucket_of(h), key, h), this);
+        }
+
+        //在哈希值为h的元素该在的桶头新建节点，必要时先扩容
+        template<class... Args>
+        iterator link_new(size_t h, Args &&... args) {
+            // 检查负载因子是否超过阈值，若超过则扩容
+            if (static_cast<double>(size_) / buckets.size() >= max_load_) {
+                expand();
+            }
+            node_type *node = pool.create(std::forward<Args>(args)...);
+            node->hash = h;
+            link_head(bucket_of(h), node);
+            ++size_;
+            return iterator(node, this);
+        }
+
+        template<class V>
+        sjtu::pair<iterator, bool> insert_value(V &&value_pair) {
+            migrate(MIGRATE_STEP);
+            size_t h = Hash{}(value_pair.first);
+            auto found = find_hashed(value_pair.first, h);
+            if (found != end()) {
+                // 如果键已经存在，更新值
+                found->second = std::forward<V>(value_pair).second;
+                return {found, false};
+            }
+            return {link_new(h, std::forward<V>(value_pair)), true};
+        }
+
+        template<class K, class... Args>
+        sjtu::pair<iterator, bool> try_emplace_key(K &&key, Args &&... args) {
+            migrate(MIGRATE_STEP);
+            size_t h = Hash{}(key);
+            auto found = find_hashed(key, h);
+            if (found != end()) {
+                return {found, false};
+            }
+            return {link_new(h, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...)), true};
+        }
+
+    public:
+        iterator end() const {
+            return iterator(nullptr, this);
+        }
+
+        //在键所在的桶里查找
+        iterator find(const Key &key) const {
+            return find_hashed(key, Hash{}(key));
+        }
+
+        //透明查找，key只用来算哈希和比较
+        template<class K> requires transparent_lookup<Hash, Equal>
+        iterator find(const K &key) const {
+            return find_hashed(key, Hash{}(key));
+        }
+
+        //批量查找，out[i]为keys[i]的结果
+        //每BATCH_SIZE个键一组：先全部算哈希并预取桶，再预取桶里的第一个节点，最后才逐个探测，让各键的缓存缺失重叠
+        void find_many(std::span<const Key> keys, std::span<iterator> out) const {
+            if (out.size() < keys.size()) {
+                throw std::invalid_argument("find_many: output span too small");
+            }
+            //桶只定位一次，取模是除法，不便宜
+            size_t h[BATCH_SIZE];
+            node_type **bucket[BATCH_SIZE];
+            for (size_t base = 0; base < keys.size(); base += BATCH_SIZE) {
+                size_t n = std::min(BATCH_SIZE, keys.size() - base);
+                for (size_t i = 0; i < n; ++i) {
+                    h[i] = Hash{}(keys[base + i]);
+                    bucket[i] = &const_cast<hashmap *>(this)->bucket_of(h[i]);
+                    prefetch(bucket[i]);
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    prefetch(*bucket[i]);
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    out[base + i] = iterator(find_in(*bucket[i], keys[base + i], h[i]), this);
+                }
+            }
+        }
+
+        size_t count(const Key &key) const {
+            return find(key) != end() ? 1 : 0;
+        }
+
+        template<class K> requires transparent_lookup<Hash, Equal>
+        size_t count(const K &key) const {
+            return find(key) != end() ? 1 : 0;
+        }
+
+        //插入，如果存在，更新，如果不存在，插入新元素，注意是否要扩容
+        sjtu::pair<iterator, bool> insert(const value_type &value_pair) {
+            return insert_value(value_pair);
+        }
+
+        //右值版本：新元素直接移进节点，已存在时移动赋值
+        sjtu::pair<iterator, bool> insert(value_type &&value_pair) {
+            return insert_value(std::move(value_pair));
+        }
+
+        //用参数构造一个元素再插入，语义同insert
+        template<class... Args>
+        sjtu::pair<iterator, bool> emplace(Args &&... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        //键不存在时用args在节点里直接构造值；键已存在时什么都不做，args不会被移动
+        template<class... Args>
+        sjtu::pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+            return try_emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        sjtu::pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+            return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+        }
+
+        //remove，找不找得到元素
+        bool remove(const Key &key) {
+            return remove_key(key);
+        }
+
+        template<class K> requires transparent_lookup<Hash, Equal>
+        bool remove(const K &key) {
+            return remove_key(key);
+        }
+
+        //已存在时返回原值，不再用T()覆盖
+        T &operator[](const Key &key) {
+            return try_emplace(key).first->second;
+        }
+
+    private:
+        template<class K>
+        bool remove_key(const K &key) {
+            migrate(MIGRATE_STEP);
+            size_t h = Hash{}(key);
+            node_type *&head = bucket_of(h);
+            node_type *node = find_in(head, key, h);
+            if (node == nullptr) {
+                return false;
+            }
+            // 如果找到键，删除该元素
+            unlink(head, node);
+            pool.destroy(node);
+            --size_;
+            return true;
+        }
+    };
+
+    //————————————————————————————————————————flat hashmap———————————————————————————————————————————————————//
+
+    //开放寻址的hashmap：所有元素放在一整块连续的槽里，每个槽配一个控制字节
+    //控制字节为EMPTY/DELETED，或者是哈希值的低7位（h2），查找时16个一组用SSE2一次比较
+    //接口与链式的hashmap一致，通过第五个模板参数flat_buckets选用
+    template<class Key, class T, class Hash, class Equal>
+    class hashmap<Key, T, Hash, Equal, flat_buckets> {
+    private:
+        using value_type = pair<const Key, T>;
+        static constexpr size_t GROUP_WIDTH = 16; //一组控制字节的个数
+        static constexpr int8_t EMPTY = -128; //空槽
+        static constexpr int8_t DELETED = -2; //删除留下的墓碑
+        static constexpr double LOAD_FACTOR_THRESHOLD = 0.875; //最大负载因子的默认值和上限，墓碑也计入
+
+        std::vector<int8_t> ctrl; //控制字节
+        value_type *slots; //槽，未初始化的内存，只有控制字节为h2的槽里有元素
+        size_t capacity_; //槽的个数，总是16的倍数且组数为2的幂
+        size_t size_; //元素个数
+        size_t deleted_; //墓碑个数
+        double max_load_; //最大负载因子
+
+        //把用户的哈希值再打散一次，防止std::hash<int>这种恒等哈希的低位聚集
+        template<class K>
+        static size_t hash_of(const K &key) {
+            size_t h = static_cast<size_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+            return h ^ (h >> 32);
+        }
+
+        static int8_t h2(size_t h) {
+            return static_cast<int8_t>(h & 0x7F);
+        }
+
+        //一组16个控制字节中等于c的位置，返回位掩码
+        static unsigned match(const int8_t *group, int8_t c) {
+#if defined(__SSE2__)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(c))));
+#else
+            unsigned mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                if (group[i] == c) {
+                    mask |= 1u << i;
+                }
+            }
+            return mask;
+#endif
+        }
+
+        //一组中EMPTY或DELETED的位置，它们的最高位都是1
+        static unsigned match_free(const int8_t *group) {
+#if defined(__SSE2__)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return static_cast<unsigned>(_mm_movemask_epi8(bytes));
+#else
+            unsigned mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                if (group[i] < 0) {
+                    mask |= 1u << i;
+                }
+            }
+            return mask;
+#endif
+        }
+
+        //查找key所在的槽，找不到返回capacity_
+        //按组做三角数探测，组数是2的幂，所以能走遍所有组；遇到含EMPTY的组就停止
+        template<class K>
+        size_t find_index(const K &key) const {
+            return find_index(key, hash_of(key));
+        }
+
+        //同上，哈希值已经算好
+        template<class K>
+        size_t find_index(const K &key, size_t h) const {
+            size_t mask = capacity_ / GROUP_WIDTH - 1;
+            size_t group = (h >> 7) & mask;
+            for (size_t step = 1;; ++step) {
+                const int8_t *g = ctrl.data() + group * GROUP_WIDTH;
+                for (unsigned m = match(g, h2(h)); m != 0; m &= m - 1) {
+                    size_t index = group * GROUP_WIDTH + std::countr_zero(m);
+                    if (Equal{}(slots[index].first, key)) {
+                        return index;
+                    }
+                }
+                if (match(g, EMPTY) != 0) {
+                    return capacity_;
+                }
+                group = (group + step) & mask;
+            }
+        }
+
+        //沿探测序列找第一个可以放元素的槽（EMPTY或DELETED）
+        size_t find_free(size_t h) const {
+            size_t mask = capacity_ / GROUP_WIDTH - 1;
+            size_t group = (h >> 7) & mask;
+            for (size_t step = 1;; ++step) {
+                unsigned m = match_free(ctrl.data() + group * GROUP_WIDTH);
+                if (m != 0) {
+                    return group * GROUP_WIDTH + std::countr_zero(m);
+                }
+                group = (group + step) & mask;
+            }
+        }
+
+        //分配n个槽，控制字节全部置为EMPTY
+        void allocate(size_t n) {
+            capacity_ = n;
+            ctrl.assign(n, EMPTY);
+            slots = std::allocator<value_type>().allocate(n);
+        }
+
+        //析构所有元素并释放槽
+        void release() {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (ctrl[i] >= 0) {
+                    slots[i].~value_type();
+                }
+            }
+            std::allocator<value_type>().deallocate(slots, capacity_);
+            slots = nullptr;
+            size_ = deleted_ = 0;
+        }
+
+        //重新分配为n个槽，把旧元素移动过去，顺便清掉所有墓碑
+        void rehash_to(size_t n) {
+            std::vector<int8_t> old_ctrl = std::move(ctrl);
+            value_type *old_slots = slots;
+            size_t old_capacity = capacity_;
+            allocate(n);
+            deleted_ = 0;
+            for (size_t i = 0; i < old_capacity; ++i) {
+                if (old_ctrl[i] >= 0) {
+                    size_t h = hash_of(old_slots[i].first);
+                    size_t index = find_free(h);
+                    new(&slots[index]) value_type(std::move(old_slots[i]));
+                    ctrl[index] = h2(h);
+                    old_slots[i].~value_type();
+                }
+            }
+            std::allocator<value_type>().deallocate(old_slots, old_capacity);
+        }
+
+        //拷贝另一个表的所有槽，要求当前没有元素
+        void copy_from(const hashmap &other) {
+            allocate(other.capacity_);
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (other.ctrl[i] >= 0) {
+                    new(&slots[i]) value_type(other.slots[i]);
                 }
             }
+            ctrl = other.ctrl;
+            size_ = other.size_;
+            deleted_ = other.deleted_;
+            max_load_ = other.max_load_;
+        }
+
+    public:
+        // --------------------------
+        //默认一组16个槽
+        hashmap() : slots(nullptr), capacity_(0), size_(0), deleted_(0), max_load_(LOAD_FACTOR_THRESHOLD) {
+            allocate(GROUP_WIDTH);
+        }
+
+        //拷贝，槽的布局原样复制，不需要重新哈希
+        hashmap(const hashmap &other)
+            : slots(nullptr), capacity_(0), size_(0), deleted_(0), max_load_(other.max_load_) {
+            copy_from(other);
         }
 
-        //析构
         ~hashmap() {
-            clear();
+            release();
         }
 
-        //赋值运算符重载
         hashmap &operator=(const hashmap &other) {
             if (this != &other) {
-                clear();
-                size_ = other.size_;
-                buckets.resize(other.buckets.size());
-                for (size_t i = 0; i < other.buckets.size(); ++i) {
-                    for (auto it = other.buckets[i].begin(); it != other.buckets[i].end(); ++it) {
-                        insert(*it);
-                    }
-                }
+                release();
+                copy_from(other);
             }
             return *this;
         }
 
-
-
-        //内置指针类
+        //内置指针类，记录槽的下标
         class iterator {
         public:
-            typename double_list<value_type>::iterator list_it; //双向列表的指针
-            size_t bucket_index; //第几位
+            size_t index; //第几个槽
             const hashmap *map; //所在的哈希表
 
-            // --------------------------
-            iterator() : bucket_index(0), map(nullptr) {
-            }
-
-            iterator(typename double_list<value_type>::iterator it, size_t index, const hashmap *m)
-                : list_it(it), bucket_index(index), map(m) {
+            iterator() : index(0), map(nullptr) {
             }
 
-            iterator(const iterator &t) : list_it(t.list_it), bucket_index(t.bucket_index), map(t.map) {
+            iterator(size_t i, const hashmap *m) : index(i), map(m) {
             }
 
-            ~iterator() {
+            iterator(const iterator &t) : index(t.index), map(t.map) {
             }
 
             value_type &operator*() const {
-                return *list_it;
+                return map->slots[index];
             }
 
             value_type *operator->() const noexcept {
-                return list_it.operator->();
+                return &map->slots[index];
             }
 
             bool operator==(const iterator &rhs) const {
-                return list_it == rhs.list_it && map == rhs.map;
+                return index == rhs.index && map == rhs.map;
             }
 
             bool operator!=(const iterator &rhs) const {
@@ -364,86 +1257,224 @@ namespace sjtu {
             }
         };
 
-        //清空
+        //清空，保留已经分配的槽
         void clear() {
-            for (auto &bucket: buckets) {
-                while (!bucket.empty()) {
-                    bucket.delete_head();
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (ctrl[i] >= 0) {
+                    slots[i].~value_type();
                 }
             }
-            size_ = 0;
+            std::fill(ctrl.begin(), ctrl.end(), EMPTY);
+            size_ = deleted_ = 0;
         }
 
         //扩容为两倍
         void expand() {
-            std::vector<double_list<value_type> > old_buckets = buckets;
-            buckets.clear();
-            buckets.resize(old_buckets.size() * 2);
-            size_ = 0;
-            for (auto &bucket: old_buckets) {
-                for (auto it = bucket.begin(); it != bucket.end(); ++it) {
-                    insert(*it);
-                }
+            rehash_to(capacity_ * 2);
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        // --------------------------
+        //槽数控制，这里的bucket就是槽
+
+        size_t bucket_count() const {
+            return capacity_;
+        }
+
+        double load_factor() const {
+            return static_cast<double>(size_) / capacity_;
+        }
+
+        double max_load_factor() const {
+            return max_load_;
+        }
+
+        //设置最大负载因子；探测靠空槽终止，所以不能超过默认的0.875
+        void max_load_factor(double ml) {
+            if (!(ml > 0)) {
+                throw std::invalid_argument("max_load_factor must be positive");
+            }
+            max_load_ = std::min(ml, LOAD_FACTOR_THRESHOLD);
+            if (static_cast<double>(size_ + deleted_) > capacity_ * max_load_) {
+                rehash(0);
+            }
+        }
+
+        //重建为至少n个槽，同时保证当前元素不超过最大负载因子；槽数向上取到16乘以2的幂
+        void rehash(size_t n) {
+            n = std::max(n, static_cast<size_t>(size_ / max_load_) + 1);
+            n = std::bit_ceil((n + GROUP_WIDTH - 1) / GROUP_WIDTH) * GROUP_WIDTH;
+            if (n != capacity_ || deleted_ != 0) {
+                rehash_to(n);
+            }
+        }
+
+        //预留能放下n个元素而不扩容的槽
+        void reserve(size_t n) {
+            if (static_cast<double>(n) > capacity_ * max_load_) {
+                rehash(static_cast<size_t>(n / max_load_) + 1);
             }
         }
 
         iterator end() const {
-            return iterator(typename double_list<value_type>::iterator(), buckets.size(), this);
+            return iterator(capacity_, this);
         }
 
-        //在桶里查找
         iterator find(const Key &key) const {
-            Hash hasher;
-            size_t index = hasher(key) % buckets.size();
-            for (auto it = buckets[in   dex].begin(); it != buckets[index].end(); ++it) {
-                if (Equal{}(it->first, key)) {
-                    return iterator(it, index, this);
+            return iterator(find_index(key), this);
+        }
+
+        //透明查找，key只用来算哈希和比较
+        template<class K> requires transparent_lookup<Hash, Equal>
+        iterator find(const K &key) const {
+            return iterator(find_index(key), this);
+        }
+
+        //批量查找，out[i]为keys[i]的结果
+        //每BATCH_SIZE个键一组：先全部算哈希并预取各自第一组的控制字节，
+        //再按控制字节预取第一个候选槽，最后才逐个探测，让各键的缓存缺失重叠
+        void find_many(std::span<const Key> keys, std::span<iterator> out) const {
+            if (out.size() < keys.size()) {
+                throw std::invalid_argument("find_many: output span too small");
+            }
+            size_t h[BATCH_SIZE];
+            size_t mask = capacity_ / GROUP_WIDTH - 1;
+            for (size_t base = 0; base < keys.size(); base += BATCH_SIZE) {
+                size_t n = std::min(BATCH_SIZE, keys.size() - base);
+                for (size_t i = 0; i < n; ++i) {
+                    h[i] = hash_of(keys[base + i]);
+                    prefetch(ctrl.data() + ((h[i] >> 7) & mask) * GROUP_WIDTH);
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    size_t group = (h[i] >> 7) & mask;
+                    unsigned m = match(ctrl.data() + group * GROUP_WIDTH, h2(h[i]));
+                    if (m != 0) {
+                        prefetch(slots + group * GROUP_WIDTH + std::countr_zero(m));
+                    }
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    out[base + i] = iterator(find_index(keys[base + i], h[i]), this);
                 }
             }
-            return end();
+        }
+
+        size_t count(const Key &key) const {
+            return find_index(key) != capacity_ ? 1 : 0;
+        }
+
+        template<class K> requires transparent_lookup<Hash, Equal>
+        size_t count(const K &key) const {
+            return find_index(key) != capacity_ ? 1 : 0;
         }
 
         //插入，如果存在，更新，如果不存在，插入新元素，注意是否要扩容
         sjtu::pair<iterator, bool> insert(const value_type &value_pair) {
-            Hash hasher;
-            size_t index = hasher(value_pair.first) % buckets.size();
-            for (auto it = buckets[index].begin(); it != buckets[index].end(); ++it) {
-                if (Equal{}(it->first, value_pair.first)) {
-                    // 如果键已经存在，更新值
-                    it->second = value_pair.second;
-                    return {iterator(it, index, this), false};
-                }
-            }
-            // 检查负载因子是否超过阈值，若超过则扩容
-            if (static_cast<double>(size_) / buckets.size() >= LOAD_FACTOR_THRESHOLD) {
-                expand();
-                index = hasher(value_pair.first) % buckets.size();
-            }
-            // 在桶的头部插入新元素
-            buckets[index].insert_head(value_pair);
-            ++size_;
-            return {iterator(buckets[index].begin(), index, this), true};
+            return insert_value(value_pair);
+        }
+
+        sjtu::pair<iterator, bool> insert(value_type &&value_pair) {
+            return insert_value(std::move(value_pair));
+        }
+
+        template<class... Args>
+        sjtu::pair<iterator, bool> emplace(Args &&... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        //键不存在时在槽里直接构造，已存在时不动args
+        template<class... Args>
+        sjtu::pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+            return try_emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        sjtu::pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+            return try_emplace_key(std::move(key), std::forward<Args>(args)...);
         }
 
         //remove，找不找得到元素
         bool remove(const Key &key) {
-            Hash hasher;
-            size_t index = hasher(key) % buckets.size();
-            // 遍历当前桶中的每个元素
-            for (auto it = buckets[index].begin(); it != buckets[index].end(); ++it) {
-                if (Equal{}(it->first, key)) {
-                    // 如果找到键，删除该元素
-                    buckets[index].erase(it);
-                    --size_;
-                    return true;
+            return erase_index(find_index(key));
+        }
+
+        template<class K> requires transparent_lookup<Hash, Equal>
+        bool remove(const K &key) {
+            return erase_index(find_index(key));
+        }
+
+        T &operator[](const Key &key) {
+            return try_emplace(key).first->second;
+        }
+
+    private:
+        //删除index处的元素，index为capacity_表示没找到
+        //所在组里还有EMPTY时说明没有探测序列经过这一组，可以直接置为EMPTY，否则留下墓碑
+        bool erase_index(size_t index) {
+            if (index == capacity_) {
+                return false;
+            }
+            slots[index].~value_type();
+            const int8_t *group = ctrl.data() + index / GROUP_WIDTH * GROUP_WIDTH;
+            if (match(group, EMPTY) != 0) {
+                ctrl[index] = EMPTY;
+            } else {
+                ctrl[index] = DELETED;
+                ++deleted_;
+            }
+            --size_;
+            return true;
+        }
+
+        //为新元素找一个空槽，必要时先重建；返回槽下标，调用方负责构造元素并调用occupy
+        size_t reserve_slot(size_t h) {
+            // 元素加墓碑超过阈值时重建：元素多就扩容，否则原大小重建只为清掉墓碑
+            if (static_cast<double>(size_ + deleted_ + 1) > capacity_ * max_load_) {
+                if (static_cast<double>(size_ + 1) > capacity_ * max_load_ / 2) {
+                    expand();
+                } else {
+                    rehash_to(capacity_);
                 }
             }
-            return false;
+            return find_free(h);
         }
 
-        T &operator[](const Key &key) {
-            auto result = insert(value_type(key, T()));
-            return result.first->second;
+        void occupy(size_t index, size_t h) {
+            if (ctrl[index] == DELETED) {
+                --deleted_;
+            }
+            ctrl[index] = h2(h);
+            ++size_;
+        }
+
+        template<class V>
+        sjtu::pair<iterator, bool> insert_value(V &&value_pair) {
+            size_t index = find_index(value_pair.first);
+            if (index != capacity_) {
+                slots[index].second = std::forward<V>(value_pair).second;
+                return {iterator(index, this), false};
+            }
+            size_t h = hash_of(value_pair.first);
+            index = reserve_slot(h);
+            new(&slots[index]) value_type(std::forward<V>(value_pair));
+            occupy(index, h);
+            return {iterator(index, this), true};
+        }
+
+        template<class K, class... Args>
+        sjtu::pair<iterator, bool> try_emplace_key(K &&key, Args &&... args) {
+            size_t index = find_index(key);
+            if (index != capacity_) {
+                return {iterator(index, this), false};
+            }
+            size_t h = hash_of(key);
+            index = reserve_slot(h);
+            new(&slots[index]) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+            occupy(index, h);
+            return {iterator(index, this), true};
         }
     };
 
@@ -455,28 +1486,151 @@ namespace sjtu {
         class T,
         class Hash = std::hash<Key>,
         class Equal = std::equal_to<Key> >
-    class linked_hashmap : public hashmap<Key, T, Hash, Equal> {
+    class linked_hashmap {
     public:
-        friend class hashmap<Key, T, Hash, Equal>;
         typedef pair<const Key, T> value_type;
+        using node_type = LinkedNode<value_type>;
+
+        // 节点池，insert_list的节点都从这里取，被删除或淘汰的节点回到池里复用
+        node_pool<node_type> pool;
+
+        //不拥有节点的链表：析构时只把自己置空，double_list的析构就不会去delete节点池里的节点
+        struct node_list : double_list<value_type, node_type> {
+            node_list() = default;
+
+            node_list(const node_list &) = delete;
+
+            node_list &operator=(const node_list &) = delete;
+
+            ~node_list() {
+                this->forget();
+            }
+        };
+
+        // 用于维护插入顺序的双向链表；节点由本表用pool创建和销毁，链表只负责串起来
+        node_list insert_list;
+
+        // 哈希桶，每个桶是一条由hash_next串起来的单链，不拥有节点
+        bucket_table<node_type> buckets;
+        static constexpr double LOAD_FACTOR_THRESHOLD = 0.75; //默认的最大负载因子
+        double max_load_ = LOAD_FACTOR_THRESHOLD; //最大负载因子，超过时扩容
+
+    private:
+        //渐进式扩容，做法同hashmap：扩容时旧表先留着，每次insert/remove顺手搬MIGRATE_STEP个旧桶
+        //旧表中下标不小于migrate_pos的桶还没搬，哈希到这些桶的元素都在旧表里；old_buckets为空表示没有在搬迁
+        bucket_table<node_type> old_buckets;
+        size_t migrate_pos = 0; //下一个要搬的旧桶
+        static constexpr size_t MIGRATE_STEP = 4; //每次操作最多搬的旧桶数
+
+        //哈希值为h的元素所在的桶
+        node_type *&bucket_of(size_t h) {
+            if (!old_buckets.empty()) {
+                size_t index = h % old_buckets.size();
+                if (index >= migrate_pos) {
+                    return old_buckets[index];
+                }
+            }
+            return buckets[h % buckets.size()];
+        }
 
-        // 用于维护插入顺序的双向链表
-        double_list<value_type> insert_list;
+        node_type *bucket_of(size_t h) const {
+            return const_cast<linked_hashmap *>(this)->bucket_of(h);
+        }
+
+        //在从head开始的桶里查找哈希值为h的节点，先比缓存的哈希值，相等才调用Equal；找不到返回nullptr
+        template<class K>
+        static node_type *find_in(node_type *head, const K &key, size_t h) {
+            for (node_type *node = head; node != nullptr; node = node->hash_next) {
+                if (node->hash == h && Equal{}(node->data.first, key)) {
+                    return node;
+                }
+            }
+            return nullptr;
+        }
+
+        template<class K>
+        node_type *find_node(const K &key, size_t h) const {
+            return find_in(bucket_of(h), key, h);
+        }
+
+        //同上，index为键在当前表里的桶下标，搬迁期间不一定是它所在的桶
+        template<class K>
+        node_type *find_node(const K &key, size_t h, size_t index) const {
+            return rehashing() ? find_node(key, h) : find_in(buckets[index], key, h);
+        }
+
+        template<class K>
+        node_type *find_node(const K &key) const {
+            return find_node(key, Hash{}(key));
+        }
+
+        //把节点挂到所在桶的头部，用节点里缓存的哈希值定位，扩容时也不重新哈希
+        void link_bucket(node_type *node) {
+            node_type *&head = bucket_of(node->hash);
+            node->hash_next = head;
+            head = node;
+        }
+
+        //把节点从所在桶的单链上摘下
+        void unlink_bucket(node_type *node) {
+            node_type **link = &bucket_of(node->hash);
+            while (*link != node) {
+                link = &(*link)->hash_next;
+            }
+            *link = node->hash_next;
+            node->hash_next = nullptr;
+        }
+
+        //搬迁最多step个旧桶，只改hash_next，节点和插入顺序都不动；搬完后释放旧表
+        void migrate(size_t step) {
+            while (step > 0 && !old_buckets.empty()) {
+                node_type *node = old_buckets[migrate_pos];
+                old_buckets[migrate_pos] = nullptr;
+                while (node != nullptr) {
+                    node_type *next = node->hash_next;
+                    node_type *&head = buckets[node->hash % buckets.size()];
+                    node->hash_next = head;
+                    head = node;
+                    node = next;
+                }
+                if (++migrate_pos == old_buckets.size()) {
+                    bucket_table<node_type>().swap(old_buckets);
+                }
+                --step;
+            }
+        }
+
+        //一次性重建为n个桶，节点不动，只重新串桶内的单链
+        void rebucket(size_t n) {
+            migrate(old_buckets.size());
+            buckets = bucket_table<node_type>(n);
+            for (node_type *node = insert_list.head; node != nullptr; node = node->next) {
+                link_bucket(node);
+            }
+        }
+
+        //扩容为两倍：只分配一张清零的新表，旧表留给之后的insert/remove逐步搬迁
+        //上一轮还没搬完时先搬完（步长4保证默认负载因子下走不到这里）
+        void expand() {
+            migrate(old_buckets.size());
+            old_buckets.swap(buckets);
+            buckets = bucket_table<node_type>(old_buckets.size() * 2);
+            migrate_pos = 0;
+        }
 
-        // 键到链表节点的映射，额外维护
-        hashmap<Key, Node<value_type> *, Hash, Equal> key_to_node;
+    public:
         // --------------------------
         class const_iterator;
 
         class iterator {
         public:
-            Node<value_type> *current;
+            node_type *current;
             linked_hashmap *map;
 
             iterator() : current(nullptr), map(nullptr) {
             }
 
-            iterator(Node<value_type> *node, linked_hashmap *m) : current(node), map(m) {
+            iterator(node_type *node, linked_hashmap *m) : current(node), map(m) {
             }
 
             iterator(const iterator &other) : current(other.current), map(other.map) {
@@ -485,8 +1639,8 @@ namespace sjtu {
             ~iterator() {
             }
 
-            typename double_list<value_type>::iterator getDoubleListIterator() {
-                return typename double_list<value_type>::iterator(current, &map->insert_list);
+            typename double_list<value_type, node_type>::iterator getDoubleListIterator() {
+                return typename double_list<value_type, node_type>::iterator(current, &map->insert_list);
             }
 
             //前后置的++--
@@ -564,13 +1718,13 @@ namespace sjtu {
         //const iterator基本同iterator
         class const_iterator {
         public:
-            const Node<value_type> *current;
+            const node_type *current;
             const linked_hashmap *map;
 
             const_iterator() : current(nullptr), map(nullptr) {
             }
 
-            const_iterator(const Node<value_type> *node, const linked_hashmap *m) : current(node), map(m) {
+            const_iterator(const node_type *node, const linked_hashmap *m) : current(node), map(m) {
             }
 
             const_iterator(const iterator &other) : current(other.current), map(other.map) {
@@ -646,80 +1800,126 @@ namespace sjtu {
             }
         };
 
-        linked_hashmap() : hashmap<Key, T, Hash, Equal>() {
+    private:
+        //把尾部的新节点记下哈希值并挂到桶里
+        iterator link_new(size_t h) {
+            insert_list.tail->hash = h;
+            link_bucket(insert_list.tail);
+            return iterator(insert_list.tail, this);
+        }
+
+        //算出items里每个键的哈希值和桶下标存入h和index，并预取对应的桶和桶里的第一个节点
+        template<class Item, class GetKey>
+        void prefetch_buckets(std::span<const Item> items, size_t *h, size_t *index, GetKey get_key) const {
+            for (size_t i = 0; i < items.size(); ++i) {
+                h[i] = Hash{}(get_key(items[i]));
+                index[i] = h[i] % buckets.size();
+                prefetch(buckets.begin() + index[i]);
+            }
+            for (size_t i = 0; i < items.size(); ++i) {
+                prefetch(buckets[index[i]]);
+            }
+        }
+
+        //把other的元素按顺序接进来，要求当前为空且桶数与other相同
+        //拷贝元素抛异常时析构已经拷好的元素并清空，再把异常抛出去（拷贝构造时析构函数不会执行）
+        void copy_from(const linked_hashmap &other) {
+            try {
+                for (node_type *node = other.insert_list.head; node != nullptr; node = node->next) {
+                    insert_list.link_tail(pool.create(node->data));
+                    link_new(node->hash);
+                }
+            } catch (...) {
+                clear();
+                throw;
+            }
+        }
+
+        template<class V>
+        pair<iterator, bool> insert_value(V &&value) {
+            return insert_hashed(std::forward<V>(value), Hash{}(value.first));
+        }
+
+        //同insert，键的哈希值h已经算好
+        template<class V>
+        pair<iterator, bool> insert_hashed(V &&value, size_t h) {
+            migrate(MIGRATE_STEP);
+            node_type *node = find_node(value.first, h);
+            if (node != nullptr) {
+                node->data.second = std::forward<V>(value).second;
+                insert_list.move_to_tail(node);
+                return {iterator(node, this), false};
+            }
+            // 检查负载因子是否超过阈值，若超过则扩容
+            if (static_cast<double>(size()) / buckets.size() >= max_load_) {
+                expand();
+            }
+            insert_list.link_tail(pool.create(std::forward<V>(value)));
+            return {link_new(h), true};
         }
 
-        linked_hashmap(const linked_hashmap &other) : hashmap<Key, T, Hash, Equal>(other) {
-            // 复制插入顺序链表
-            for (auto it = other.insert_list.begin(); it != other.insert_list.end(); ++it) {
-                insert_list.insert_tail(*it);
-                key_to_node.insert({it->first, insert_list.tail});
+        template<class K, class... Args>
+        pair<iterator, bool> try_emplace_key(K &&key, Args &&... args) {
+            migrate(MIGRATE_STEP);
+            size_t h = Hash{}(key);
+            node_type *node = find_node(key, h);
+            if (node != nullptr) {
+                return {iterator(node, this), false};
+            }
+            if (static_cast<double>(size()) / buckets.size() >= max_load_) {
+                expand();
             }
+            insert_list.link_tail(pool.create(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                              std::forward_as_tuple(std::forward<Args>(args)...)));
+            return {link_new(h), true};
+        }
+
+    public:
+        linked_hashmap() : buckets(16) {
+        }
+
+        //拷贝，按插入顺序逐个接到尾部，复杂度n；桶数相同，直接用缓存的哈希值
+        linked_hashmap(const linked_hashmap &other)
+            : buckets(other.buckets.size()), max_load_(other.max_load_) {
+            copy_from(other);
         }
 
         ~linked_hashmap() {
-            // 清理插入顺序链表
-            insert_list.clear();
-            key_to_node.clear();
+            clear();
         }
 
         linked_hashmap &operator=(const linked_hashmap &other) {
             if (this != &other) {
-                // 先赋值基类部分
-                hashmap<Key, T, Hash, Equal>::operator=(other);
-                // 清理当前插入顺序链表
-                insert_list.clear();
-                key_to_node.clear();
-                // 复制新的插入顺序链表
-                for (auto it = other.insert_list.begin(); it != other.insert_list.end(); ++it) {
-                    insert_list.insert_tail(*it);
-                    key_to_node.insert({it->first, it.current});
-                }
+                clear();
+                buckets = bucket_table<node_type>(other.buckets.size());
+                max_load_ = other.max_load_;
+                copy_from(other);
             }
             return *this;
         }
 
         T &at(const Key &key) {
-            auto it = hashmap<Key, T, Hash, Equal>::find(key);
-            if (it == hashmap<Key, T, Hash, Equal>::end()) {
+            node_type *node = find_node(key);
+            if (node == nullptr) {
                 throw std::out_of_range("Key not found");
             }
-            return it->second;
+            return node->data.second;
         }
 
         const T &at(const Key &key) const {
-            auto it = hashmap<Key, T, Hash, Equal>::find(key);
-            if (it == hashmap<Key, T, Hash, Equal>::end()) {
+            node_type *node = find_node(key);
+            if (node == nullptr) {
                 throw std::out_of_range("Key not found");
             }
-            return it->second;
+            return node->data.second;
         }
 
         T &operator[](const Key &key) {
-            auto it = hashmap<Key, T, Hash, Equal>::find(key);
-            if (it == hashmap<Key, T, Hash, Equal>::end()) {
-                throw std::out_of_range("Key not found");
-            }
-            auto result = hashmap<Key, T, Hash, Equal>::insert(value_type(key, T()));
-            if (result.second) {
-                insert_list.insert_tail(*result.first);
-                key_to_node.insert({key, insert_list.tail});
-            } else {
-                // 若键已存在，移动到插入顺序链表头部
-                auto list_it = find(key);
-                insert_list.erase(list_it.getDoubleListIterator());
-                insert_list.insert_head(*result.first);
-                key_to_node[key] = insert_list.head;
-            }
-            return result.first->second;
+            return at(key);
         }
 
         const T &operator[](const Key &key) const {
-            auto it = hashmap<Key, T, Hash, Equal>::find(key);
-            if (it == hashmap<Key, T, Hash, Equal>::end()) {
-                throw std::out_of_range("Key not found");
-            }
-            return it->second;
+            return at(key);
         }
 
         iterator begin() {
@@ -742,116 +1942,351 @@ namespace sjtu {
             return insert_list.empty();
         }
 
+        //清空，桶只需置空，节点池整块释放；元素可平凡析构时不用逐个析构节点
         void clear() {
-            hashmap<Key, T, Hash, Equal>::clear();
-            insert_list.clear();
-            key_to_node.clear();
+            if constexpr (!std::is_trivially_destructible_v<value_type>) {
+                for (node_type *node = insert_list.head; node != nullptr;) {
+                    node_type *next = node->next;
+                    pool.destroy(node);
+                    node = next;
+                }
+            }
+            insert_list.forget();
+            pool.release();
+            buckets.reset();
+            bucket_table<node_type>().swap(old_buckets);
+            migrate_pos = 0;
         }
 
         size_t size() const {
             return insert_list.size;
         }
 
-        //在插入新的键值对时，如果该键是首次插入，会在 insert_list 的尾部插入新节点，
-        //同时将该键和对应的节点指针插入到 key_to_node 中。
-        //如果键已经存在，需要将对应的节点移动到双向链表的尾部以更新插入顺序，此时可以通过 key_to_node 快速找到该节点。
-        pair<iterator, bool> insert(const value_type &value) {
-            auto hash_result = hashmap<Key, T, Hash, Equal>::insert(value);
-            iterator new_it;
-            if (hash_result.second) {
-                // 在插入顺序链表插入新元素
-                insert_list.insert_tail(value);
-                key_to_node[value.first] = insert_list.tail;
-                // 找到在插入顺序链表中的位置
-                new_it = iterator(insert_list.tail, this);
-            } else {
-                // 若键已存在，移动到插入顺序链表尾部
-                auto it = key_to_node.find(value.first);
-                if (it != key_to_node.end()) {
-                    Node<value_type>* old_node = it->second;
-                    auto list_it = iterator(old_node, this);
-                    insert_list.erase(list_it.getDoubleListIterator());
-                    insert_list.insert_tail(value);
-                    key_to_node[value.first] = insert_list.tail;
+        //是否正在渐进式扩容
+        bool rehashing() const {
+            return !old_buckets.empty();
+        }
 
-                }
-                new_it = begin();
+        // --------------------------
+        //桶数控制，与hashmap一致：rehash/reserve一次性重建，不走渐进式搬迁
+
+        //桶的个数（不含搬迁中的旧表）
+        size_t bucket_count() const {
+            return buckets.size();
+        }
+
+        double load_factor() const {
+            return static_cast<double>(size()) / buckets.size();
+        }
+
+        double max_load_factor() const {
+            return max_load_;
+        }
+
+        void max_load_factor(double ml) {
+            if (!(ml > 0)) {
+                throw std::invalid_argument("max_load_factor must be positive");
+            }
+            max_load_ = ml;
+            if (load_factor() >= max_load_) {
+                rehash(0);
+            }
+        }
+
+        //重建为至少n个桶，且桶数足够让当前元素不超过最大负载因子
+        void rehash(size_t n) {
+            n = std::max({n, static_cast<size_t>(size() / max_load_) + 1, size_t(1)});
+            if (n != buckets.size()) {
+                rebucket(n);
+            }
+        }
+
+        //预留能放下n个元素而不扩容的桶和节点
+        void reserve(size_t n) {
+            if (static_cast<double>(n) / buckets.size() >= max_load_) {
+                rehash(static_cast<size_t>(n / max_load_) + 1);
+            }
+            if (n > size()) {
+                pool.reserve(n - size());
             }
-            return {new_it, hash_result.second};
+        }
+
+        //在插入新的键值对时，如果该键是首次插入，新建一个节点，挂到桶里并接到 insert_list 的尾部。
+        //如果键已经存在，更新值，并把原节点移动到双向链表的尾部以更新插入顺序，不重新分配节点。
+        pair<iterator, bool> insert(const value_type &value) {
+            return insert_value(value);
+        }
+
+        //右值版本：新节点里的元素由value移动构造，已存在时移动赋值
+        pair<iterator, bool> insert(value_type &&value) {
+            return insert_value(std::move(value));
+        }
+
+        template<class... Args>
+        pair<iterator, bool> emplace(Args &&... args) {
+            return insert(value_type(std::forward<Args>(args)...));
+        }
+
+        //键不存在时用args在新节点里直接构造值并接到尾部；键已存在时不更新值、不移动节点，args也不会被移动
+        template<class... Args>
+        pair<iterator, bool> try_emplace(const Key &key, Args &&... args) {
+            return try_emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        pair<iterator, bool> try_emplace(Key &&key, Args &&... args) {
+            return try_emplace_key(std::move(key), std::forward<Args>(args)...);
         }
 
         void remove(iterator pos) {
             if (pos.current == nullptr) {
                 throw std::runtime_error("Invalid iterator");
             }
-            auto x = pos-> first;
-            // 从哈希表中删除元素
-            hashmap<Key, T, Hash, Equal>::remove(x);
-            // 从插入顺序链表中删除元素
-            insert_list.erase(pos.getDoubleListIterator());
-            key_to_node.remove(x);
+            migrate(MIGRATE_STEP);
+            unlink_bucket(pos.current);
+            insert_list.unlink(pos.current);
+            pool.destroy(pos.current);
+        }
+
+        //把pos指向的节点原地移到插入顺序的尾部（最近使用端），不拷贝也不分配，原有迭代器和指针保持有效
+        void touch(iterator pos) {
+            if (pos.current == nullptr) {
+                throw std::runtime_error("Invalid iterator");
+            }
+            insert_list.move_to_tail(pos.current);
         }
 
         size_t count(const Key &key) const {
-            return (hashmap<Key, T, Hash, Equal>::find(key) != hashmap<Key, T, Hash, Equal>::end()) ? 1 : 0;
+            return find_node(key) != nullptr ? 1 : 0;
+        }
+
+        //透明查找，key只用来算哈希和比较
+        template<class K> requires transparent_lookup<Hash, Equal>
+        size_t count(const K &key) const {
+            return find_node(key) != nullptr ? 1 : 0;
         }
 
         iterator find(const Key &key) {
-            auto it = key_to_node.find(key);
-            if (it == key_to_node.end()) {
-                return end();
+            return iterator(find_node(key), this);
+        }
+
+        template<class K> requires transparent_lookup<Hash, Equal>
+        iterator find(const K &key) {
+            return iterator(find_node(key), this);
+        }
+
+        //批量查找，out[i]为keys[i]的结果
+        //每BATCH_SIZE个键一组：先全部算哈希并预取桶，再预取桶里的第一个节点，最后才逐个探测
+        void find_many(std::span<const Key> keys, std::span<iterator> out) {
+            if (out.size() < keys.size()) {
+                throw std::invalid_argument("find_many: output span too small");
+            }
+            size_t h[BATCH_SIZE], index[BATCH_SIZE];
+            for (size_t base = 0; base < keys.size(); base += BATCH_SIZE) {
+                size_t n = std::min(BATCH_SIZE, keys.size() - base);
+                prefetch_buckets(keys.subspan(base, n), h, index, [](const Key &key) -> const Key & { return key; });
+                for (size_t i = 0; i < n; ++i) {
+                    out[base + i] = iterator(find_node(keys[base + i], h[i], index[i]), this);
+                }
+            }
+        }
+
+        //批量插入，效果等同于按顺序逐个insert，每插入一个就调用一次after(insert的返回值)
+        //哈希和预取按BATCH_SIZE一组提前做，after里可以删除元素（lru用它淘汰）
+        template<class F>
+        void insert_many(std::span<const value_type> values, F &&after) {
+            size_t h[BATCH_SIZE], index[BATCH_SIZE];
+            for (size_t base = 0; base < values.size(); base += BATCH_SIZE) {
+                size_t n = std::min(BATCH_SIZE, values.size() - base);
+                prefetch_buckets(values.subspan(base, n), h, index,
+                                 [](const value_type &v) -> const Key & { return v.first; });
+                for (size_t i = 0; i < n; ++i) {
+                    after(insert_hashed(values[base + i], h[i]));
+                }
             }
-            return iterator(it->second, this);
         }
     };
 
     //———————————————————————————————————————lru———————————————————————————————————————————————————————————//
 
+    //缓存，键为Key，值为Value；默认参数即原来的Integer -> Matrix<int>缓存，所以sjtu::lru cache(n)照旧可用
+    //linked_hashmap直接作为成员，不再多一次堆上的间接访问
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
     class lru {
-        using lmap = sjtu::linked_hashmap<Integer, Matrix<int>, Hash, Equal>;
-        using value_type = sjtu::pair<const Integer, Matrix<int> >;
+        using lmap = sjtu::linked_hashmap<Key, Value, KeyHash, KeyEqual>;
+        using value_type = sjtu::pair<const Key, Value>;
+
+        size_t capacity;
+        lmap memory;
+        template<class K>
+        Value *get_key(const K &v) {
+            auto it = memory.find(v);
+            if (it != memory.end()) {
+                // 命中时原地把节点移到最近使用端，返回的指针在该元素被淘汰前一直有效
+                memory.touch(it);
+                return &(it->second);
+            }
+            return nullptr;
+        }
+
+        //插入新元素后检查容量，超出时淘汰最早的
+        void evict() {
+            if (memory.size() > capacity) {
+                memory.remove(memory.begin());
+            }
+        }
 
-        int capacity;
-        lmap *memory;
     public:
+        //按容量预留好桶和节点，稳定运行时不再扩容（淘汰前会短暂多出一个元素）
         lru(int size) : capacity(size) {
-            memory = new linked_hashmap<Integer, Matrix<int>, Hash, Equal>();
+            memory.reserve(capacity + 1);
         }
 
-        ~lru() {
-            delete memory;
+        //插入：查找是否有k，如果没有，检查容量，判断是否删除最早的
+        void save(const value_type &v) {
+            if (memory.insert(v).second) {
+                evict();
+            }
         }
 
-        //插入：查找是否有k，如果没有，检查容量，判断是否删除最早的
-        void save(const value_type &v)const {
-            auto result = memory->insert(v);
-            if (!result.second) {
-                // 键已存在，insert函数已处理值的更新和位置移动
-            } else {
-                // 插入新元素后检查容量
-                if (memory->size() > capacity) {
-                    auto first = memory->begin();
-                    memory->remove(first);
+        //右值版本，值直接移进节点
+        void save(value_type &&v) {
+            if (memory.insert(std::move(v)).second) {
+                evict();
+            }
+        }
+
+        //用args构造值存入key：已存在时替换旧值并移到最近使用端，否则在新节点里直接构造
+        template<class... Args>
+        Value *emplace(const Key &key, Args &&... args) {
+            auto it = memory.find(key);
+            if (it != memory.end()) {
+                it->second = Value(std::forward<Args>(args)...);
+                memory.touch(it);
+                return &(it->second);
+            }
+            Value *value = &(memory.try_emplace(key, std::forward<Args>(args)...).first->second);
+            evict();
+            // 容量为0时新元素会被立刻淘汰
+            return memory.empty() ? nullptr : value;
+        }
+
+        //只在key不存在时构造；已存在时返回原值（并移到最近使用端），args不会被使用
+        //second表示是否新插入
+        template<class... Args>
+        sjtu::pair<Value *, bool> try_emplace(const Key &key, Args &&... args) {
+            auto result = memory.try_emplace(key, std::forward<Args>(args)...);
+            Value *value = &(result.first->second);
+            if (result.second) {
+                evict();
+                if (memory.empty()) {
+                    value = nullptr;
                 }
+            } else {
+                memory.touch(result.first);
             }
+            return {value, result.second};
+        }
+
+        Value *get(const Key &v) {
+            return get_key(v);
+        }
+
+        //命中时同get；未命中时调用loader(key)算出值存进去，返回存好的值
+        //loader抛异常时什么都不存；容量为0时存进去就被淘汰，返回nullptr
+        //lru本身不是线程安全的，多线程下的合并加载见concurrent_lru::get_or_load
+        template<class Loader>
+        Value *get_or_load(const Key &key, Loader &&loader) {
+            auto it = memory.find(key);
+            if (it != memory.end()) {
+                memory.touch(it);
+                return &(it->second);
+            }
+            return try_emplace(key, loader(key)).first;
         }
 
-        Matrix<int> *get(const Integer &v) const{
-            auto it = memory->find(v);
-            if (it != memory->end()) {
-                Integer key = it->first;
-                Matrix<int> value = it->second;
-                memory->remove(it);
-                auto newIt = memory->insert({key,std::move(value)}).first; // 获取插入后的新迭代器
-                return &(newIt->second);
+        //批量get，out[i]为keys[i]的结果，效果等同于按顺序逐个get；返回命中的个数
+        //查找在linked_hashmap::find_many里按批预取，多个键的缓存缺失可以重叠
+        size_t get_many(std::span<const Key> keys, std::span<Value *> out) {
+            if (out.size() < keys.size()) {
+                throw std::invalid_argument("get_many: output span too small");
+            }
+            typename lmap::iterator found[BATCH_SIZE];
+            size_t hits = 0;
+            for (size_t base = 0; base < keys.size(); base += BATCH_SIZE) {
+                size_t n = std::min(BATCH_SIZE, keys.size() - base);
+                memory.find_many(keys.subspan(base, n), std::span(found, n));
+                for (size_t i = 0; i < n; ++i) {
+                    if (found[i].current != nullptr) {
+                        prefetch(found[i].current->prev);
+                        prefetch(found[i].current->next);
+                    }
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    if (found[i] != memory.end()) {
+                        memory.touch(found[i]);
+                        out[base + i] = &(found[i]->second);
+                        ++hits;
+                    } else {
+                        out[base + i] = nullptr;
+                    }
+                }
             }
-            return nullptr;
+            return hits;
+        }
+
+        //批量save，效果等同于按顺序逐个save
+        void save_many(std::span<const value_type> values) {
+            memory.insert_many(values, [this](const auto &result) {
+                if (result.second) {
+                    evict();
+                }
+            });
+        }
+
+        //KeyHash和KeyEqual透明时可以直接用int等查找，如cache.get(5)不会构造Integer
+        template<class K> requires transparent_lookup<KeyHash, KeyEqual>
+        Value *get(const K &v) {
+            return get_key(v);
+        }
+
+        size_t size() const {
+            return memory.size();
+        }
+
+        //以下转发给底层的linked_hashmap
+        size_t bucket_count() const {
+            return memory.bucket_count();
+        }
+
+        double load_factor() const {
+            return memory.load_factor();
+        }
+
+        double max_load_factor() const {
+            return memory.max_load_factor();
+        }
+
+        void max_load_factor(double ml) {
+            memory.max_load_factor(ml);
+        }
+
+        void rehash(size_t n) {
+            memory.rehash(n);
+        }
+
+        void reserve(size_t n) {
+            memory.reserve(n);
         }
 
         void print() {
-            auto it = memory->begin();
-            for (; it != memory->end(); ++it) {
-                std::cout << (*it).first.val << " " << (*it).second << std::endl;
+            auto it = memory.begin();
+            for (; it != memory.end(); ++it) {
+                std::cout << (*it).first << " " << (*it).second << std::endl;
             }
         }
     };
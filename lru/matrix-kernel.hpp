@@ -0,0 +1,475 @@
+#ifndef SJTU_MATRIX_KERNEL_HPP
+#define SJTU_MATRIX_KERNEL_HPP
+
+/**
+    矩阵乘法的分块内核，只处理按行连续存放的裸指针，Matrix 的 operator* 调用它
+        matrix_kernel :: gemm < T >(m, n, k, a, b, c)   // c += a * b
+    按 NC 列、KC 层、MC 行三层分块：先把 b 的一块打包成每 NR 列一条的面板（同一个 k 的 NR 个数相邻），
+    再把 a 的一块打包成每 MR 行一条的面板（同一个 k 的 MR 个数相邻），
+    最内层的微内核把 MR*NR 个累加值放在寄存器里，每个 k 只读 MR 个 a 和 NR 个 b。
+    微内核用的向量指令在编译时按目标选择：
+        float/double：有 AVX 用 256 位，否则有 SSE2 用 128 位；
+        int：有 AVX2 用 256 位，否则有 SSE4.1 用 128 位；
+        其他情况（包括其他算术类型）用标量版本。
+    打包用的缓冲区是 thread_local 的，只在需要更大时重新分配。
+    多线程时 b 的每块只由调用线程打包一次，各线程共用，再各自打包自己那几行的 a。
+
+    按行块并行执行的线程池
+        matrix_kernel :: thread_pool :: instance()
+        matrix_kernel :: parallel_for(n, cost, f)   // f(begin, end) 处理 [begin, end) 这些行
+    工作量（n * cost）不到 PARALLEL_WORK 时直接在调用线程里串行算。
+    线程池只有一个任务槽：已经有任务在跑、或者在线程池的任务里再调用时，也退回串行，不会互相等待。
+    工作线程和调用线程一起按块领取行，领完并且都做完才返回。
+    f 抛出的异常（不论在哪个线程）会让剩下的块不再领取，等所有线程停下后在调用线程重新抛出第一个。
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace matrix_kernel {
+    //————————————————————————————————————————————————————————//
+    // 一个向量寄存器的操作，标量版本的宽度是1
+    template<typename T>
+    struct simd {
+        using reg = T;
+        static constexpr size_t width = 1;
+
+        static reg zero() {
+            return T(0);
+        }
+
+        static reg load(const T *p) {
+            return *p;
+        }
+
+        static reg broadcast(const T &x) {
+            return x;
+        }
+
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) {
+            return acc + a * b;
+        }
+
+        static void store(T *p, const reg &r) {
+            *p = r;
+        }
+    };
+
+#if defined(__AVX__)
+    template<>
+    struct simd<float> {
+        using reg = __m256;
+        static constexpr size_t width = 8;
+
+        static reg zero() { return _mm256_setzero_ps(); }
+        static reg load(const float *p) { return _mm256_loadu_ps(p); }
+        static reg broadcast(const float &x) { return _mm256_set1_ps(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm256_add_ps(acc, _mm256_mul_ps(a, b)); }
+        static void store(float *p, const reg &r) { _mm256_storeu_ps(p, r); }
+    };
+
+    template<>
+    struct simd<double> {
+        using reg = __m256d;
+        static constexpr size_t width = 4;
+
+        static reg zero() { return _mm256_setzero_pd(); }
+        static reg load(const double *p) { return _mm256_loadu_pd(p); }
+        static reg broadcast(const double &x) { return _mm256_set1_pd(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm256_add_pd(acc, _mm256_mul_pd(a, b)); }
+        static void store(double *p, const reg &r) { _mm256_storeu_pd(p, r); }
+    };
+#elif defined(__SSE2__)
+    template<>
+    struct simd<float> {
+        using reg = __m128;
+        static constexpr size_t width = 4;
+
+        static reg zero() { return _mm_setzero_ps(); }
+        static reg load(const float *p) { return _mm_loadu_ps(p); }
+        static reg broadcast(const float &x) { return _mm_set1_ps(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+        static void store(float *p, const reg &r) { _mm_storeu_ps(p, r); }
+    };
+
+    template<>
+    struct simd<double> {
+        using reg = __m128d;
+        static constexpr size_t width = 2;
+
+        static reg zero() { return _mm_setzero_pd(); }
+        static reg load(const double *p) { return _mm_loadu_pd(p); }
+        static reg broadcast(const double &x) { return _mm_set1_pd(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm_add_pd(acc, _mm_mul_pd(a, b)); }
+        static void store(double *p, const reg &r) { _mm_storeu_pd(p, r); }
+    };
+#endif
+
+#if defined(__AVX2__)
+    template<>
+    struct simd<int> {
+        using reg = __m256i;
+        static constexpr size_t width = 8;
+
+        static reg zero() { return _mm256_setzero_si256(); }
+        static reg load(const int *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static reg broadcast(const int &x) { return _mm256_set1_epi32(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm256_add_epi32(acc, _mm256_mullo_epi32(a, b)); }
+        static void store(int *p, const reg &r) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), r); }
+    };
+#elif defined(__SSE4_1__)
+    template<>
+    struct simd<int> {
+        using reg = __m128i;
+        static constexpr size_t width = 4;
+
+        static reg zero() { return _mm_setzero_si128(); }
+        static reg load(const int *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+        static reg broadcast(const int &x) { return _mm_set1_epi32(x); }
+        static reg mul_add(const reg &acc, const reg &a, const reg &b) { return _mm_add_epi32(acc, _mm_mullo_epi32(a, b)); }
+        static void store(int *p, const reg &r) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), r); }
+    };
+#endif
+
+    //————————————————————————————————————————————————————————//
+    // 分块大小：微内核算 MR 行 * NR 列，a 的面板约 MC*KC 个数放在 L2，b 的打包块约 KC*NC 个数放在 L3
+    template<typename T>
+    struct blocking {
+        static constexpr size_t MR = 4;
+        static constexpr size_t NR_REGS = simd<T>::width == 1 ? 4 : 2; //每行用几个向量寄存器
+        static constexpr size_t NR = NR_REGS * simd<T>::width;
+        static constexpr size_t KC = 256;
+        static constexpr size_t MC = 64;
+        static constexpr size_t NC = 1024;
+    };
+
+    // 乘加次数不超过这个数的乘法不打包，直接按 i-k-j 顺序算
+    constexpr size_t SMALL_GEMM = 32 * 32 * 32;
+
+    // 把 b 的 kc 行 nc 列（行距 ldb）打包：每 NR 列一条面板，面板里第 p 层的 NR 个数相邻，不足的补0
+    template<typename T>
+    void pack_b(size_t kc, size_t nc, const T *b, size_t ldb, T *out) {
+        constexpr size_t NR = blocking<T>::NR;
+        for (size_t j = 0; j < nc; j += NR) {
+            size_t cols = std::min(NR, nc - j);
+            for (size_t p = 0; p < kc; ++p) {
+                const T *row = b + p * ldb + j;
+                size_t jj = 0;
+                for (; jj < cols; ++jj) {
+                    out[jj] = row[jj];
+                }
+                for (; jj < NR; ++jj) {
+                    out[jj] = T(0);
+                }
+                out += NR;
+            }
+        }
+    }
+
+    // 把 a 的 mc 行 kc 列（行距 lda）打包：每 MR 行一条面板，面板里第 p 层的 MR 个数相邻，不足的补0
+    template<typename T>
+    void pack_a(size_t mc, size_t kc, const T *a, size_t lda, T *out) {
+        constexpr size_t MR = blocking<T>::MR;
+        for (size_t i = 0; i < mc; i += MR) {
+            size_t rows = std::min(MR, mc - i);
+            for (size_t p = 0; p < kc; ++p) {
+                size_t ii = 0;
+                for (; ii < rows; ++ii) {
+                    out[ii] = a[(i + ii) * lda + p];
+                }
+                for (; ii < MR; ++ii) {
+                    out[ii] = T(0);
+                }
+                out += MR;
+            }
+        }
+    }
+
+    // c 的 m*n 个数（m<=MR，n<=NR）加上打包好的 a 面板乘 b 面板
+    template<typename T>
+    void micro_kernel(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t m, size_t n) {
+        using S = simd<T>;
+        constexpr size_t MR = blocking<T>::MR;
+        constexpr size_t V = blocking<T>::NR_REGS;
+        constexpr size_t W = S::width;
+        typename S::reg acc[MR][V];
+        for (size_t i = 0; i < MR; ++i) {
+            for (size_t v = 0; v < V; ++v) {
+                acc[i][v] = S::zero();
+            }
+        }
+        for (size_t p = 0; p < kc; ++p) {
+            typename S::reg bv[V];
+            for (size_t v = 0; v < V; ++v) {
+                bv[v] = S::load(b + v * W);
+            }
+            for (size_t i = 0; i < MR; ++i) {
+                typename S::reg ai = S::broadcast(a[i]);
+                for (size_t v = 0; v < V; ++v) {
+                    acc[i][v] = S::mul_add(acc[i][v], ai, bv[v]);
+                }
+            }
+            a += MR;
+            b += V * W;
+        }
+        T tile[MR][V * W];
+        for (size_t i = 0; i < MR; ++i) {
+            for (size_t v = 0; v < V; ++v) {
+                S::store(tile[i] + v * W, acc[i][v]);
+            }
+        }
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                c[i * ldc + j] += tile[i][j];
+            }
+        }
+    }
+
+    // 不打包的小乘法，c += a * b
+    template<typename T>
+    void gemm_small(size_t m, size_t n, size_t k, const T *a, const T *b, T *c) {
+        for (size_t i = 0; i < m; ++i) {
+            T *c_row = c + i * n;
+            for (size_t p = 0; p < k; ++p) {
+                const T a_ip = a[i * k + p];
+                const T *b_row = b + p * n;
+                for (size_t j = 0; j < n; ++j) {
+                    c_row[j] += a_ip * b_row[j];
+                }
+            }
+        }
+    }
+
+    //————————————————————————————————————————————————————————//
+    // 工作量达到这么多（大约是这么多次简单运算）才分给多个线程
+    constexpr size_t PARALLEL_WORK = 1 << 18;
+
+    class thread_pool {
+        using task = void (*)(void *, size_t, size_t);
+
+        std::vector<std::thread> workers;
+        std::mutex submit; //同一时间只跑一个任务
+        std::mutex lock; //保护下面的任务状态
+        std::condition_variable wake; //有新任务或者要退出
+        std::condition_variable done; //工作线程都做完了
+        uint64_t generation = 0; //任务的编号，工作线程靠它发现新任务
+        size_t active = 0; //还没做完当前任务的工作线程数
+        bool stop = false;
+
+        // 当前任务：对 [0, total) 按 chunk 一块一块地调用 fn(ctx, begin, end)
+        task fn = nullptr;
+        void *ctx = nullptr;
+        size_t total = 0;
+        size_t chunk = 1;
+        std::atomic<size_t> next{0}; //下一块的起点
+        std::exception_ptr error; //当前任务里第一个抛出的异常，受 lock 保护
+
+        // 当前线程是否正在执行池里的任务，是的话嵌套的并行调用直接串行
+        static bool &inside() {
+            thread_local bool flag = false;
+            return flag;
+        }
+
+        // 领块直到领完；fn 抛异常时记下来，并让所有线程不再领新的块
+        void drain() {
+            try {
+                size_t begin;
+                while ((begin = next.fetch_add(chunk)) < total) {
+                    fn(ctx, begin, std::min(total, begin + chunk));
+                }
+            } catch (...) {
+                next.store(total);
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        // seen 是线程创建时的任务编号，之后编号变了就是来了新任务
+        void work(uint64_t seen) {
+            inside() = true;
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                wake.wait(guard, [&] { return stop || generation != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = generation;
+                guard.unlock();
+                drain();
+                guard.lock();
+                if (--active == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+
+        void start(size_t threads) {
+            stop = false;
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this, seen = generation] { work(seen); });
+            }
+        }
+
+        void join() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stop = true;
+            }
+            wake.notify_all();
+            for (auto &t: workers) {
+                t.join();
+            }
+            workers.clear();
+        }
+
+    public:
+        explicit thread_pool(size_t threads) {
+            start(threads);
+        }
+
+        ~thread_pool() {
+            join();
+        }
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        // 全局的线程池，调用线程也干活，所以工作线程比核数少一个
+        static thread_pool &instance() {
+            static thread_pool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+            return pool;
+        }
+
+        // 换成 threads 个工作线程，会等正在跑的任务结束
+        void resize(size_t threads) {
+            std::lock_guard<std::mutex> hold(submit);
+            join();
+            start(threads);
+        }
+
+        // 参与计算的线程数，包括调用线程
+        size_t size() const {
+            return workers.size() + 1;
+        }
+
+        // 把 [0, n) 分块交给所有线程执行 f(begin, end)，每块至少 grain 个；不能并行时在本线程直接执行 f(0, n)
+        template<typename F>
+        void run(size_t n, size_t grain, F &f) {
+            if (workers.empty() || inside() || n <= grain || !submit.try_lock()) {
+                f(0, n);
+                return;
+            }
+            std::lock_guard<std::mutex> hold(submit, std::adopt_lock);
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                fn = [](void *c, size_t begin, size_t end) { (*static_cast<F *>(c))(begin, end); };
+                ctx = &f;
+                total = n;
+                chunk = std::max(grain, (n + 4 * size() - 1) / (4 * size()));
+                next.store(0);
+                error = nullptr;
+                active = workers.size();
+                ++generation;
+            }
+            wake.notify_all();
+            // drain 不抛异常，所以工作线程都停下之前 f 一直有效，inside() 也一定会复位
+            inside() = true;
+            drain();
+            inside() = false;
+            std::exception_ptr failed;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                done.wait(guard, [&] { return active == 0; });
+                std::swap(failed, error);
+            }
+            if (failed) {
+                std::rethrow_exception(failed);
+            }
+        }
+    };
+
+    // 对 [0, n) 执行 f(begin, end)，每一项的工作量约为 cost；总量够大时分给线程池
+    template<typename F>
+    void parallel_for(size_t n, size_t cost, F f) {
+        cost = std::max<size_t>(cost, 1);
+        if (n * cost < PARALLEL_WORK) {
+            f(0, n);
+            return;
+        }
+        thread_pool::instance().run(n, std::max<size_t>(PARALLEL_WORK / 4 / cost, 1), f);
+    }
+
+    // 用打包好的一块 b（kc 层 nc 列）乘 a 的 m 行 kc 列（行距 lda），累加到 c（行距 ldc）
+    template<typename T>
+    void gemm_panel(size_t m, size_t nc, size_t kc, const T *a, size_t lda, const T *b_pack, T *c, size_t ldc) {
+        using B = blocking<T>;
+        thread_local std::vector<T> a_pack;
+        size_t a_need = (B::MC + B::MR - 1) / B::MR * B::MR * B::KC;
+        if (a_pack.size() < a_need) {
+            a_pack.resize(a_need);
+        }
+        for (size_t ic = 0; ic < m; ic += B::MC) {
+            size_t mc = std::min(B::MC, m - ic);
+            pack_a(mc, kc, a + ic * lda, lda, a_pack.data());
+            for (size_t jr = 0; jr < nc; jr += B::NR) {
+                for (size_t ir = 0; ir < mc; ir += B::MR) {
+                    micro_kernel(kc, a_pack.data() + ir * kc, b_pack + jr * kc,
+                                 c + (ic + ir) * ldc + jr, ldc,
+                                 std::min(B::MR, mc - ir), std::min(B::NR, nc - jr));
+                }
+            }
+        }
+    }
+
+    // 分块乘法，c(m*n) += a(m*k) * b(k*n)；b 的每块在调用线程打包一次，再按 c 的行块分给线程池
+    template<typename T>
+    void gemm_blocked(size_t m, size_t n, size_t k, const T *a, const T *b, T *c) {
+        using B = blocking<T>;
+        thread_local std::vector<T> b_pack;
+        size_t b_need = (B::NC + B::NR - 1) / B::NR * B::NR * B::KC;
+        if (b_pack.size() < b_need) {
+            b_pack.resize(b_need);
+        }
+        for (size_t jc = 0; jc < n; jc += B::NC) {
+            size_t nc = std::min(B::NC, n - jc);
+            for (size_t pc = 0; pc < k; pc += B::KC) {
+                size_t kc = std::min(B::KC, k - pc);
+                pack_b(kc, nc, b + pc * n + jc, n, b_pack.data());
+                const T *packed = b_pack.data();
+                // 向量化之后一次乘加远比一次简单运算便宜，按 nc*kc/8 估计一行的工作量
+                parallel_for(m, nc * kc / 8, [&](size_t begin, size_t end) {
+                    gemm_panel(end - begin, nc, kc, a + begin * k + pc, k, packed, c + begin * n + jc, n);
+                });
+            }
+        }
+    }
+
+    // c(m*n) += a(m*k) * b(k*n)，三个矩阵都按行连续存放
+    template<typename T>
+    void gemm(size_t m, size_t n, size_t k, const T *a, const T *b, T *c) {
+        if (m * n * k <= SMALL_GEMM) {
+            gemm_small(m, n, k, a, b, c);
+            return;
+        }
+        gemm_blocked(m, n, k, a, b, c);
+    }
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef SJTU_REFRESHING_LRU_HPP
+#define SJTU_REFRESHING_LRU_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lru.hpp"
+
+/**
+    写入后定时刷新（refresh-after-write）的线程安全lru
+        sjtu :: refreshing_lru < Key , Value , Hash , Equal , Clock >
+    构造时给一个loader(key)，元素在最后一次写入refresh_after之后算作“该刷新了”。
+    get命中这样的元素时照常立刻返回当前的值，同时把这个键交给内部的后台线程重新加载，
+    所以热点键的读延迟里永远不包含重新计算。
+    后台加载完成后在原节点里交换新旧值，节点不离开insert_list，最近使用顺序不受影响。
+    同一个元素同时最多只有一次刷新在排队或进行；刷新期间又被save过的元素，刷新结果直接丢弃。
+    loader抛异常时保留旧值，之后的get会再次触发刷新。
+    get通过拷贝返回值，理由同concurrent_lru。Clock可以换成测试用的假时钟。
+*/
+
+namespace sjtu {
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal,
+        class Clock = std::chrono::steady_clock>
+    class refreshing_lru {
+        using value_type = sjtu::pair<const Key, Value>;
+        using duration = typename Clock::duration;
+        using time_point = typename Clock::time_point;
+
+        //值、写入时刻，以及判断刷新结果是否过时用的版本号
+        struct timed_value {
+            Value value;
+            time_point written;
+            uint64_t version; //每次写入都换一个全局唯一的版本号
+            bool refreshing; //已经有刷新在排队或进行
+            uint64_t queued_version; //排上那次刷新时的版本号，用来认出是哪次刷新结束了
+        };
+
+        //一次刷新任务，带上排队时元素的版本号
+        struct job {
+            Key key;
+            uint64_t version;
+        };
+
+        //loader的类型擦除，不用std::function
+        struct loader_base {
+            virtual ~loader_base() = default;
+
+            virtual Value load(const Key &key) = 0;
+        };
+
+        template<class F>
+        struct loader_impl : loader_base {
+            F f;
+
+            explicit loader_impl(F f) : f(std::move(f)) {
+            }
+
+            Value load(const Key &key) override {
+                return f(key);
+            }
+        };
+
+        size_t capacity_;
+        duration refresh_after;
+        std::unique_ptr<loader_base> loader;
+        std::mutex lock; //保护下面所有成员
+        std::condition_variable wake; //有新任务或要停止
+        std::condition_variable idle; //任务队列空了且没有正在进行的刷新
+        linked_hashmap<Key, timed_value, KeyHash, KeyEqual> memory;
+        double_list<job> jobs; //待执行的刷新，先进先出
+        size_t running = 0; //正在执行的刷新个数
+        uint64_t next_version = 0;
+        bool stop = false;
+        std::vector<std::thread> workers; //最后构造，保证线程启动时其余成员都已就绪
+
+        //后台线程：取任务，锁外调用loader，再回到锁里把新值换进原节点
+        void work() {
+            std::optional<Value> fresh;
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                wake.wait(guard, [this] { return stop || !jobs.empty(); });
+                if (stop) {
+                    return;
+                }
+                job current = std::move(jobs.head->data);
+                jobs.delete_head();
+                ++running;
+                guard.unlock();
+                // fresh里可能还留着上一次换下来的旧值，在锁外析构
+                fresh.reset();
+                try {
+                    fresh.emplace(loader->load(current.key));
+                } catch (...) {
+                }
+                guard.lock();
+                --running;
+                auto it = memory.find(current.key);
+                // 元素已被淘汰后重新插入时，它的刷新标记不属于这次刷新，不能动
+                if (it != memory.end() && it->second.refreshing && it->second.queued_version == current.version) {
+                    // 刷新期间又被save过时，这次的结果作废
+                    if (fresh && it->second.version == current.version) {
+                        std::swap(it->second.value, *fresh);
+                        it->second.written = Clock::now();
+                        it->second.version = next_version++;
+                    }
+                    it->second.refreshing = false;
+                }
+                if (jobs.empty() && running == 0) {
+                    idle.notify_all();
+                }
+            }
+        }
+
+    public:
+        //threads为后台刷新线程的个数
+        template<class Loader>
+        refreshing_lru(int size, duration refresh_after, Loader loader, size_t threads = 1)
+            : capacity_(size), refresh_after(refresh_after),
+              loader(std::make_unique<loader_impl<Loader> >(std::move(loader))) {
+            if (threads == 0) {
+                throw std::invalid_argument("refreshing_lru needs at least one worker thread");
+            }
+            memory.reserve(capacity_ + 1);
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+
+        refreshing_lru(const refreshing_lru &) = delete;
+
+        refreshing_lru &operator=(const refreshing_lru &) = delete;
+
+        //还在排队的刷新直接丢弃，正在进行的等它结束
+        ~refreshing_lru() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stop = true;
+            }
+            wake.notify_all();
+            for (auto &worker: workers) {
+                worker.join();
+            }
+        }
+
+        //插入或更新，写入时刻记为现在；正在进行的刷新结果会被丢弃。
+        //刷新标记不动，由那次刷新结束时清掉，否则刷新期间的get会再排一次
+        void save(const value_type &v) {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = memory.find(v.first);
+            if (it != memory.end()) {
+                it->second.value = v.second;
+                it->second.written = Clock::now();
+                it->second.version = next_version++;
+                memory.touch(it);
+                return;
+            }
+            memory.insert(pair<const Key, timed_value>(
+                v.first, timed_value{v.second, Clock::now(), next_version++, false, 0}));
+            if (memory.size() > capacity_) {
+                memory.remove(memory.begin());
+            }
+        }
+
+        //命中时把当前的值拷贝到out并返回true，不等待刷新；到了刷新时间就顺便排一次后台刷新
+        bool get(const Key &key, Value &out) {
+            std::lock_guard<std::mutex> guard(lock);
+            auto it = memory.find(key);
+            if (it == memory.end()) {
+                return false;
+            }
+            memory.touch(it);
+            out = it->second.value;
+            if (!it->second.refreshing && Clock::now() - it->second.written >= refresh_after) {
+                it->second.refreshing = true;
+                it->second.queued_version = it->second.version;
+                jobs.insert_tail(job{key, it->second.version});
+                wake.notify_one();
+            }
+            return true;
+        }
+
+        //等到所有已经排上的刷新都完成
+        void drain() {
+            std::unique_lock<std::mutex> guard(lock);
+            idle.wait(guard, [this] { return jobs.empty() && running == 0; });
+        }
+
+        size_t size() {
+            std::lock_guard<std::mutex> guard(lock);
+            return memory.size();
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        //从旧到新输出
+        void print() {
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto it = memory.begin(); it != memory.end(); ++it) {
+                std::cout << (*it).first << " " << (*it).second.value << std::endl;
+            }
+        }
+    };
+}
+
+#endif
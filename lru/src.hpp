@@ -1 +1,8 @@
 #include "lru.hpp"
+#include "concurrent-lru.hpp"
+#include "clock-lru.hpp"
+#include "tinylfu-lru.hpp"
+#include "arc-lru.hpp"
+#include "weighted-lru.hpp"
+#include "expiring-lru.hpp"
+#include "refreshing-lru.hpp"
@@ -0,0 +1,218 @@
+#ifndef SJTU_TINYLFU_LRU_HPP
+#define SJTU_TINYLFU_LRU_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "lru.hpp"
+
+/**
+    带准入过滤的缓存（W-TinyLFU），接口同lru
+        sjtu :: frequency_sketch < Key , Hash >
+        sjtu :: tinylfu_lru < Key , Value , Hash , Equal >
+    新元素先进容量约1%的窗口LRU；被挤出窗口的候选者要和主缓存试用区最旧的元素比访问频率，
+    频率更高才能进入主缓存，否则直接丢掉，这样一次性的扫描不会冲掉常用的元素。
+    主缓存是分段LRU：试用区（probation）和保护区（protected，占主缓存80%），
+    试用区里再次被访问的元素升入保护区，保护区满了把最旧的降回试用区。
+    三段都是linked_hashmap。
+    访问频率用4位计数的count-min sketch估计，累计的增加次数达到容量的10倍时所有计数减半（老化）。
+*/
+
+namespace sjtu {
+    //4位计数的count-min sketch，每个uint64_t放16个计数器，每个键在4行里各占一个
+    template<class Key, class KeyHash>
+    class frequency_sketch {
+    private:
+        static constexpr uint64_t SEEDS[4] = {
+            0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull, 0x9ae16a3b2f90404full, 0xcbf29ce484222325ull
+        };
+
+        std::vector<uint64_t> table;
+        size_t mask; //table.size() - 1
+        size_t additions; //上次老化以来计数增加的次数
+        size_t sample_size; //增加到这么多次就老化
+
+        //第i行对应的计数器：低4位选字里的第几个计数器，其余位选字
+        void locate(size_t h, int i, size_t &word, int &shift) const {
+            uint64_t x = (h + SEEDS[i]) * 0x9E3779B97F4A7C15ull;
+            x ^= x >> 32;
+            word = (x >> 4) & mask;
+            shift = static_cast<int>(x & 15) * 4;
+        }
+
+        //所有计数减半
+        void age() {
+            for (auto &w: table) {
+                w = (w >> 1) & 0x7777777777777777ull;
+            }
+            additions /= 2;
+        }
+
+    public:
+        explicit frequency_sketch(size_t capacity) : additions(0) {
+            size_t n = 1;
+            while (n < capacity) {
+                n *= 2;
+            }
+            table.assign(n, 0);
+            mask = n - 1;
+            sample_size = capacity == 0 ? 10 : 10 * capacity;
+        }
+
+        //记一次访问，到15的计数器不再增加
+        void increment(const Key &key) {
+            size_t h = KeyHash{}(key);
+            bool added = false;
+            for (int i = 0; i < 4; ++i) {
+                size_t word;
+                int shift;
+                locate(h, i, word, shift);
+                if (((table[word] >> shift) & 15) != 15) {
+                    table[word] += 1ull << shift;
+                    added = true;
+                }
+            }
+            if (added && ++additions >= sample_size) {
+                age();
+            }
+        }
+
+        //估计的访问频率，取4行里的最小值
+        int frequency(const Key &key) const {
+            size_t h = KeyHash{}(key);
+            int result = 15;
+            for (int i = 0; i < 4; ++i) {
+                size_t word;
+                int shift;
+                locate(h, i, word, shift);
+                result = std::min(result, static_cast<int>((table[word] >> shift) & 15));
+            }
+            return result;
+        }
+    };
+
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class tinylfu_lru {
+        using lmap = sjtu::linked_hashmap<Key, Value, KeyHash, KeyEqual>;
+        using value_type = sjtu::pair<const Key, Value>;
+
+        size_t window_capacity; //窗口的容量
+        size_t main_capacity; //主缓存（试用区+保护区）的容量
+        size_t protected_capacity; //保护区的容量
+        lmap window;
+        lmap probation;
+        lmap protected_;
+        frequency_sketch<Key, KeyHash> sketch;
+
+        //把it指向的元素换到to的最新端，值移动过去，不拷贝
+        static typename lmap::iterator transfer(lmap &from, typename lmap::iterator it, lmap &to) {
+            auto result = to.try_emplace(it->first, std::move(it->second));
+            from.remove(it);
+            return result.first;
+        }
+
+        //试用区的元素被再次访问，升入保护区；保护区超了就把最旧的降回试用区
+        Value *promote(typename lmap::iterator it) {
+            if (protected_capacity == 0) {
+                probation.touch(it);
+                return &(it->second);
+            }
+            auto promoted = transfer(probation, it, protected_);
+            if (protected_.size() > protected_capacity) {
+                transfer(protected_, protected_.begin(), probation);
+            }
+            return &(promoted->second);
+        }
+
+        //窗口超了，把最旧的元素作为候选者，和试用区最旧的比频率决定谁留下
+        void evict_window() {
+            auto candidate = window.begin();
+            if (probation.size() + protected_.size() < main_capacity) {
+                transfer(window, candidate, probation);
+                return;
+            }
+            if (main_capacity > 0) {
+                lmap &victims = probation.empty() ? protected_ : probation;
+                auto victim = victims.begin();
+                if (sketch.frequency(candidate->first) > sketch.frequency(victim->first)) {
+                    victims.remove(victim);
+                    transfer(window, candidate, probation);
+                    return;
+                }
+            }
+            window.remove(candidate);
+        }
+
+        //在三段里找键，命中时按所在段调整位置，返回值的指针
+        Value *access(const Key &key) {
+            auto it = window.find(key);
+            if (it != window.end()) {
+                window.touch(it);
+                return &(it->second);
+            }
+            it = protected_.find(key);
+            if (it != protected_.end()) {
+                protected_.touch(it);
+                return &(it->second);
+            }
+            it = probation.find(key);
+            if (it != probation.end()) {
+                return promote(it);
+            }
+            return nullptr;
+        }
+
+    public:
+        //窗口占1%（至少1个），剩下的是主缓存，其中80%是保护区
+        tinylfu_lru(int size) : sketch(size) {
+            size_t capacity = size;
+            window_capacity = std::max<size_t>(1, capacity / 100);
+            if (window_capacity > capacity) {
+                window_capacity = capacity;
+            }
+            main_capacity = capacity - window_capacity;
+            protected_capacity = main_capacity * 4 / 5;
+        }
+
+        //插入：已有则更新值并当作一次访问；新元素进窗口，窗口满了再决定候选者去留
+        void save(const value_type &v) {
+            sketch.increment(v.first);
+            Value *value = access(v.first);
+            if (value != nullptr) {
+                *value = v.second;
+                return;
+            }
+            if (window_capacity == 0) {
+                return;
+            }
+            window.insert(v);
+            if (window.size() > window_capacity) {
+                evict_window();
+            }
+        }
+
+        Value *get(const Key &v) {
+            sketch.increment(v);
+            return access(v);
+        }
+
+        size_t size() const {
+            return window.size() + probation.size() + protected_.size();
+        }
+
+        //依次输出窗口、试用区、保护区，每段从旧到新
+        void print() {
+            for (lmap *segment: {&window, &probation, &protected_}) {
+                for (auto it = segment->begin(); it != segment->end(); ++it) {
+                    std::cout << (*it).first << " " << (*it).second << std::endl;
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -1,11 +1,19 @@
 #ifndef SJTU_UTILITY_HPP
 #define SJTU_UTILITY_HPP
 
+#include <cstddef>
+#include <tuple>
 #include <utility>
 namespace sjtu {
 
 template<class T1, class T2>
 class pair {
+	//分段构造：把两个tuple里的参数分别转发给first和second的构造函数
+	template<class Tuple1, class Tuple2, std::size_t... I1, std::size_t... I2>
+	pair(Tuple1 &args1, Tuple2 &args2, std::index_sequence<I1...>, std::index_sequence<I2...>)
+		: first(std::forward<std::tuple_element_t<I1, Tuple1> >(std::get<I1>(args1))...),
+		  second(std::forward<std::tuple_element_t<I2, Tuple2> >(std::get<I2>(args2))...) {}
+
 public:
 	T1 first;
 	T2 second;
@@ -13,13 +21,19 @@ public:
 	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 
 	template<class U1, class U2>
-	pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+	pair(U1 &&x, U2 &&y) : first(std::forward<U1>(x)), second(std::forward<U2>(y)) {}
 
 	template<class U1, class U2>
 	pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
 
 	template<class U1, class U2>
-	pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+	pair(pair<U1, U2> &&other) : first(std::forward<U1>(other.first)), second(std::forward<U2>(other.second)) {}
+
+	//pair(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(rows, cols))
+	//直接用参数构造first和second，不产生临时对象
+	template<class... Args1, class... Args2>
+	pair(std::piecewise_construct_t, std::tuple<Args1...> args1, std::tuple<Args2...> args2)
+		: pair(args1, args2, std::index_sequence_for<Args1...>{}, std::index_sequence_for<Args2...>{}) {}
 };
 
 }
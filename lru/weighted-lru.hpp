@@ -0,0 +1,112 @@
+#ifndef SJTU_WEIGHTED_LRU_HPP
+#define SJTU_WEIGHTED_LRU_HPP
+
+#include "lru.hpp"
+
+/**
+    按权重（字节数）限制容量的lru
+        sjtu :: default_weigher < Value >
+        sjtu :: weighted_lru < Key , Value , Weigher , Hash , Equal >
+    每个元素存进来时用Weigher算一次权重并记在节点里，所有元素的权重之和不超过预算。
+    超出预算时从insert_list最旧的一端开始淘汰，直到满足预算。
+    权重比整个预算还大的元素不缓存。
+    默认的Weigher对Matrix<T>取RowSize()*ColSize()*sizeof(T)，对其他类型取sizeof(Value)。
+*/
+
+namespace sjtu {
+    template<class Value>
+    struct default_weigher {
+        size_t operator()(const Value &) const {
+            return sizeof(Value);
+        }
+    };
+
+    template<class T>
+    struct default_weigher<Matrix<T> > {
+        size_t operator()(const Matrix<T> &m) const {
+            return m.RowSize() * m.ColSize() * sizeof(T);
+        }
+    };
+
+    template<
+        class Key = Integer,
+        class Value = Matrix<int>,
+        class Weigher = default_weigher<Value>,
+        class KeyHash = ::Hash,
+        class KeyEqual = ::Equal>
+    class weighted_lru {
+        //值和它存进来时的权重，淘汰时按记下的权重扣除，不再重新计算
+        struct weighted_value {
+            Value value;
+            size_t weight;
+        };
+
+        using lmap = sjtu::linked_hashmap<Key, weighted_value, KeyHash, KeyEqual>;
+        using value_type = sjtu::pair<const Key, Value>;
+
+        size_t budget_; //权重预算
+        size_t weight_; //当前的总权重
+        lmap memory;
+
+    public:
+        explicit weighted_lru(size_t budget) : budget_(budget), weight_(0) {
+        }
+
+        //插入或更新后，从最旧的一端淘汰到总权重不超过预算；新元素在最新端，不会被自己挤掉
+        void save(const value_type &v) {
+            size_t weight = Weigher{}(v.second);
+            auto it = memory.find(v.first);
+            if (it != memory.end()) {
+                weight_ -= it->second.weight;
+                if (weight > budget_) {
+                    memory.remove(it);
+                    return;
+                }
+                it->second.value = v.second;
+                it->second.weight = weight;
+                memory.touch(it);
+            } else {
+                if (weight > budget_) {
+                    return;
+                }
+                memory.insert(pair<const Key, weighted_value>(v.first, weighted_value{v.second, weight}));
+            }
+            weight_ += weight;
+            while (weight_ > budget_) {
+                auto oldest = memory.begin();
+                weight_ -= oldest->second.weight;
+                memory.remove(oldest);
+            }
+        }
+
+        //返回的值不要改成别的大小，权重按存进来时的算
+        Value *get(const Key &v) {
+            auto it = memory.find(v);
+            if (it == memory.end()) {
+                return nullptr;
+            }
+            memory.touch(it);
+            return &(it->second.value);
+        }
+
+        size_t size() const {
+            return memory.size();
+        }
+
+        size_t weight() const {
+            return weight_;
+        }
+
+        size_t budget() const {
+            return budget_;
+        }
+
+        void print() {
+            for (auto it = memory.begin(); it != memory.end(); ++it) {
+                std::cout << (*it).first << " " << (*it).second.value << std::endl;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: concurrent save & get",
+    "test2: aggregate size",
+    "test3: lock-free get under concurrent save",
+    "test4: buffered recency",
+    "test5: capacity smaller than shard count",
+    "test6: reader slots released on thread exit",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+void concurrent_lru_tester() {
+    //Integer::counter不是原子的，多线程下用int作键
+    using value_type = sjtu::pair<int, Matrix<int> >;
+    using cache_type = sjtu::concurrent_lru<int, Matrix<int>, std::hash<int>, std::equal_to<int> >;
+    const int threads = 8;
+    const int n = 2000;
+    const int capacity = 4000;
+    cache_type cache(capacity, 8);
+    std::atomic<bool> wrong(false);
+    //每个线程存自己的一段键，再读回刚存过的键，读到的值必须正确
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            Matrix<int> value;
+            for (int i = 0; i < n; i++) {
+                int key = t * n + i;
+                cache.save(value_type(key, Matrix<int>(2, 2, key)));
+                int back = t * n + i / 2;
+                if (cache.get(back, value) && !(value == Matrix<int>(2, 2, back))) {
+                    wrong = true;
+                }
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    std::cout << c[2] << (wrong ? c[1] : c[0]) << std::endl;
+    //一共存了threads * n个不同的键，远超容量，所以每个分片都是满的
+    std::cout << c[3] << (cache.size() == capacity ? c[0] : c[1]) << std::endl;
+}
+
+void read_buffered_lru_tester() {
+    using value_type = sjtu::pair<int, Matrix<int> >;
+    using cache_type = sjtu::read_buffered_lru<int, Matrix<int>, std::hash<int>, std::equal_to<int> >;
+    const int readers = 6;
+    const int n = 20000;
+    const int keys = 500;
+    cache_type cache(200);
+    std::atomic<bool> wrong(false);
+    std::atomic<bool> done(false);
+    //一个线程不断改写键对应的值，值始终是键的倍数；读者读到的值必须自洽
+    std::thread writer([&]() {
+        for (int i = 0; i < n; i++) {
+            int key = i % keys;
+            cache.save(value_type(key, Matrix<int>(2, 2, key * (i / keys + 1))));
+        }
+        done = true;
+    });
+    std::vector<std::thread> workers;
+    for (int t = 0; t < readers; t++) {
+        workers.emplace_back([&, t]() {
+            Matrix<int> value;
+            for (int i = 0; !done || i < n; i++) {
+                int key = (i * 7 + t) % keys;
+                if (cache.get(key, value) && (value.RowSize() != 2 || value[1][1] != value[0][0] ||
+                                              (key != 0 && value[0][0] % key != 0))) {
+                    wrong = true;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    std::cout << c[4] << (wrong || cache.size() != 200 ? c[1] : c[0]) << std::endl;
+
+    //命中记在缓冲区里，下一次save时先应用再淘汰，所以被读过的1不会被淘汰
+    cache_type small(3);
+    Matrix<int> value;
+    for (int i = 1; i <= 3; i++) {
+        small.save(value_type(i, Matrix<int>(1, 1, i)));
+    }
+    small.get(1, value);
+    small.save(value_type(4, Matrix<int>(1, 1, 4)));
+    bool ok = small.get(1, value) && !small.get(2, value) && small.get(3, value) && small.get(4, value);
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+    small.print();
+}
+
+void small_capacity_tester() {
+    using value_type = sjtu::pair<int, int>;
+    using cache_type = sjtu::concurrent_lru<int, int, std::hash<int>, std::equal_to<int> >;
+    //容量比默认的16个分片还小时，分片数降到容量，没有容量为0的分片，刚存进去的键一定读得到
+    cache_type cache(4);
+    int value;
+    bool ok = cache.shard_count() == 4;
+    for (int i = 0; i < 100; i++) {
+        cache.save(value_type(i, i));
+        ok = ok && cache.get(i, value) && value == i && cache.size() <= 4;
+    }
+    //get_or_load存进去的值之后直接命中，不再重新加载
+    cache_type tiny(1);
+    int loads = 0;
+    for (int i = 0; i < 5; i++) {
+        ok = ok && tiny.get_or_load(7, [&loads](int key) { return ++loads, key; }) == 7;
+    }
+    ok = ok && loads == 1 && tiny.shard_count() == 1 && tiny.size() == 1;
+    //容量为0时什么都存不下
+    cache_type empty(0);
+    empty.save(value_type(1, 1));
+    ok = ok && empty.size() == 0 && !empty.get(1, value);
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void reader_slot_tester() {
+    using value_type = sjtu::pair<int, int>;
+    using cache_type = sjtu::read_buffered_lru<int, int, std::hash<int>, std::equal_to<int> >;
+    cache_type cache(100);
+    for (int i = 0; i < 100; i++) {
+        cache.save(value_type(i, i));
+    }
+    //远多于64个读者槽的短命线程依次读，每个线程退出时归还自己的槽
+    std::atomic<int> hits(0);
+    for (int round = 0; round < 20; round++) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 10; t++) {
+            workers.emplace_back([&, t]() {
+                int value;
+                hits += cache.get(t, value) && value == t;
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+    bool ok = hits == 200 && cache.active_readers() == 0;
+    //还活着的线程占着槽；缓存先于线程销毁时，线程退出也不会访问已经释放的槽
+    cache_type *temporary = new cache_type(10);
+    temporary->save(value_type(1, 1));
+    std::atomic<int> stage(0);
+    std::thread reader([&]() {
+        int value;
+        cache.get(1, value);
+        temporary->get(1, value);
+        stage = 1;
+        while (stage != 2) {
+            std::this_thread::yield();
+        }
+    });
+    while (stage != 1) {
+        std::this_thread::yield();
+    }
+    ok = ok && cache.active_readers() == 1 && temporary->active_readers() == 1;
+    delete temporary;
+    stage = 2;
+    reader.join();
+    ok = ok && cache.active_readers() == 0;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+#ifdef _OUTPUT_
+    freopen("10.out","w",stdout);
+#endif
+    concurrent_lru_tester();
+    read_buffered_lru_tester();
+    small_capacity_tester();
+    reader_slot_tester();
+    std::cout << c[8] << std::endl;
+}
@@ -0,0 +1,210 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+#include <unordered_map>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: clock second chance",
+    "test2: clock random save & get",
+    "test3: tinylfu scan resistance",
+    "test4: tinylfu random save & get",
+    "test5: arc frequency phase",
+    "test6: arc random save & get",
+    "test7: weighted budget",
+    "test8: tinylfu moves values between segments",
+    "test9: arc moves values from T1 to T2",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//记录拷贝次数的值，移动不计
+struct CopyCounted {
+    static inline int copies = 0;
+    int val;
+
+    CopyCounted(int v) : val(v) {
+    }
+
+    CopyCounted(const CopyCounted &other) : val(other.val) {
+        ++copies;
+    }
+
+    CopyCounted(CopyCounted &&other) noexcept : val(other.val) {
+    }
+
+    CopyCounted &operator=(const CopyCounted &other) {
+        val = other.val;
+        ++copies;
+        return *this;
+    }
+
+    CopyCounted &operator=(CopyCounted &&other) noexcept {
+        val = other.val;
+        return *this;
+    }
+};
+
+//随机存取，命中时的值必须是最后一次存进去的值，元素个数不能超过容量
+template<class Cache>
+bool random_tester(Cache &cache, int capacity) {
+    using value_type = sjtu::pair<Integer, Matrix<int> >;
+    std::mt19937 rng(1958);
+    std::unordered_map<int, int> last;
+    for (int i = 0; i < 20000; i++) {
+        int key = rng() % 300;
+        if (rng() % 3 == 0) {
+            cache.save(value_type(Integer(key), Matrix<int>(1, 1, i)));
+            last[key] = i;
+        } else {
+            Matrix<int> *value = cache.get(Integer(key));
+            if (value != nullptr && (*value)[0][0] != last[key]) {
+                return false;
+            }
+        }
+        if (cache.size() > static_cast<size_t>(capacity)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void clock_lru_tester() {
+    using value_type = sjtu::pair<Integer, Matrix<int> >;
+    //1被读过，转指针时得到第二次机会，淘汰的是2
+    sjtu::clock_lru<> cache(3);
+    for (int i = 1; i <= 3; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    cache.get(Integer(1));
+    cache.save(value_type(Integer(4), Matrix<int>(1, 1, 4)));
+    bool ok = cache.get(Integer(1)) && !cache.get(Integer(2)) && cache.get(Integer(3)) && cache.get(Integer(4));
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+    cache.print();
+
+    sjtu::clock_lru<> big(100);
+    std::cout << c[3] << (random_tester(big, 100) ? c[0] : c[1]) << std::endl;
+}
+
+void tinylfu_lru_tester() {
+    using value_type = sjtu::pair<Integer, Matrix<int> >;
+    //常用的键反复访问之后，再来一大串只访问一次的键，常用的键应该大多还在
+    const int capacity = 100;
+    const int hot = 50;
+    sjtu::tinylfu_lru<> cache(capacity);
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < hot; i++) {
+            if (cache.get(Integer(i)) == nullptr) {
+                cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+            }
+        }
+    }
+    for (int i = 1000; i < 3000; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    int kept = 0;
+    for (int i = 0; i < hot; i++) {
+        kept += cache.get(Integer(i)) != nullptr;
+    }
+    std::cout << c[4] << (kept >= hot * 9 / 10 ? c[0] : c[1]) << std::endl;
+
+    sjtu::tinylfu_lru<> big(100);
+    std::cout << c[5] << (random_tester(big, 100) ? c[0] : c[1]) << std::endl;
+}
+
+void arc_lru_tester() {
+    using value_type = sjtu::pair<Integer, Matrix<int> >;
+    //访问过两次的键进了T2，后面一次性的扫描只在T1里打转，不会把它们挤掉
+    const int capacity = 100;
+    const int hot = 50;
+    sjtu::arc_lru<> cache(capacity);
+    for (int i = 0; i < hot; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+        cache.get(Integer(i));
+    }
+    for (int i = 1000; i < 3000; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    int kept = 0;
+    for (int i = 0; i < hot; i++) {
+        kept += cache.get(Integer(i)) != nullptr;
+    }
+    std::cout << c[6] << (kept == hot && cache.size() == capacity ? c[0] : c[1]) << std::endl;
+
+    sjtu::arc_lru<> big(100);
+    std::cout << c[7] << (random_tester(big, 100) ? c[0] : c[1]) << std::endl;
+}
+
+void weighted_lru_tester() {
+    using value_type = sjtu::pair<Integer, Matrix<int> >;
+    //预算是四个2*2的int矩阵；先放三个，再放一个3*3的矩阵要淘汰两个最旧的，太大的矩阵不缓存
+    const size_t small = 2 * 2 * sizeof(int);
+    sjtu::weighted_lru<> cache(4 * small);
+    for (int i = 1; i <= 3; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(2, 2, i)));
+    }
+    cache.get(Integer(1));
+    cache.save(value_type(Integer(4), Matrix<int>(3, 3, 4)));
+    bool ok = cache.size() == 2 && cache.get(Integer(1)) && cache.get(Integer(4)) &&
+              cache.weight() == small + 3 * 3 * sizeof(int);
+    cache.save(value_type(Integer(5), Matrix<int>(10, 10, 5)));
+    ok = ok && !cache.get(Integer(5)) && cache.size() == 2;
+    cache.save(value_type(Integer(1), Matrix<int>(1, 1, 1)));
+    ok = ok && cache.weight() == sizeof(int) + 3 * 3 * sizeof(int);
+    std::cout << c[8] << (ok ? c[0] : c[1]) << std::endl;
+    cache.print();
+}
+
+void move_tester() {
+    //窗口→试用区→保护区以及降级都移动值；只有save本身拷贝一次
+    using counted_pair = sjtu::pair<const int, CopyCounted>;
+    sjtu::tinylfu_lru<int, CopyCounted, std::hash<int>, std::equal_to<int> > counted(100);
+    CopyCounted::copies = 0;
+    int saves = 0;
+    bool ok = true;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 150; i++) {
+            CopyCounted *value = counted.get(i);
+            if (value == nullptr) {
+                counted.save(counted_pair(i, CopyCounted(i)));
+                ++saves;
+            } else {
+                ok = ok && value->val == i;
+            }
+        }
+    }
+    ok = ok && CopyCounted::copies == saves && counted.size() == 100;
+    std::cout << c[9] << (ok ? c[0] : c[1]) << std::endl;
+
+    //T1命中升入T2也是移动
+    sjtu::arc_lru<int, CopyCounted, std::hash<int>, std::equal_to<int> > arc(10);
+    for (int i = 0; i < 10; i++) {
+        arc.save(counted_pair(i, CopyCounted(i)));
+    }
+    CopyCounted::copies = 0;
+    ok = true;
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 10; i++) {
+            CopyCounted *value = arc.get(i);
+            ok = ok && value != nullptr && value->val == i;
+        }
+    }
+    ok = ok && CopyCounted::copies == 0 && arc.size() == 10;
+    std::cout << c[10] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+#ifdef _OUTPUT_
+    freopen("11.out","w",stdout);
+#endif
+    clock_lru_tester();
+    tinylfu_lru_tester();
+    arc_lru_tester();
+    weighted_lru_tester();
+    move_tester();
+    std::cout << c[11] << std::endl;
+}
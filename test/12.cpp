@@ -0,0 +1,185 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <random>
+#include <unordered_map>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: expire after write",
+    "test2: expire after access",
+    "test3: batch reap on save",
+    "test4: long ttl across wheel levels",
+    "test5: random save & get with time",
+    "test6: copy keeps its own timer wheel",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//测试用的假时钟，时间只在测试里手动往前拨
+struct manual_clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+    static constexpr bool is_steady = true;
+    static inline time_point current{};
+
+    static time_point now() {
+        return current;
+    }
+
+    static void advance(long long ms) {
+        current += duration(ms);
+    }
+};
+
+using value_type = sjtu::pair<Integer, Matrix<int> >;
+using cache_type = sjtu::expiring_lru<Integer, Matrix<int>, Hash, Equal, manual_clock>;
+using ms = std::chrono::milliseconds;
+
+void expire_after_write_tester() {
+    //读不会推迟到期，100ms后1过期，中途重新写入的2重新计时
+    cache_type cache(10, ms(100));
+    cache.save(value_type(Integer(1), Matrix<int>(1, 1, 1)));
+    cache.save(value_type(Integer(2), Matrix<int>(1, 1, 2)));
+    manual_clock::advance(60);
+    bool ok = cache.get(Integer(1)) && cache.get(Integer(2));
+    cache.save(value_type(Integer(2), Matrix<int>(1, 1, 20)));
+    manual_clock::advance(40);
+    ok = ok && !cache.get(Integer(1)) && cache.get(Integer(2)) && (*cache.get(Integer(2)))[0][0] == 20;
+    manual_clock::advance(60);
+    ok = ok && !cache.get(Integer(2)) && cache.size() == 0;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void expire_after_access_tester() {
+    //一直被读的1不过期，没人读的2过期
+    cache_type cache(10, ms(100), sjtu::expire_policy::after_access);
+    cache.save(value_type(Integer(1), Matrix<int>(1, 1, 1)));
+    cache.save(value_type(Integer(2), Matrix<int>(1, 1, 2)));
+    bool ok = true;
+    for (int i = 0; i < 10; i++) {
+        manual_clock::advance(50);
+        ok = ok && cache.get(Integer(1));
+        cache.cleanup();
+    }
+    ok = ok && !cache.get(Integer(2)) && cache.size() == 1;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+    cache.print();
+}
+
+void batch_reap_tester() {
+    //没有被读过的过期元素在下一次save时一起删掉
+    cache_type cache(100, ms(10));
+    for (int i = 0; i < 50; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    manual_clock::advance(5);
+    for (int i = 50; i < 60; i++) {
+        cache.save(value_type(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    bool ok = cache.size() == 60;
+    manual_clock::advance(5);
+    cache.save(value_type(Integer(100), Matrix<int>(1, 1, 100)));
+    ok = ok && cache.size() == 11;
+    manual_clock::advance(5);
+    cache.save(value_type(Integer(101), Matrix<int>(1, 1, 101)));
+    ok = ok && cache.size() == 2;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+    cache.print();
+}
+
+void long_ttl_tester() {
+    //ttl横跨时间轮的各层，甚至超过最高层一圈，既不能提前也不能漏掉
+    bool ok = true;
+    const long long ttls[] = {63, 64, 65, 4095, 4097, 262143, 300000, 16777215, 16777216, 40000000};
+    for (long long ttl: ttls) {
+        cache_type cache(10, ms(ttl));
+        manual_clock::advance(ttl % 97);
+        cache.save(value_type(Integer(1), Matrix<int>(1, 1, 1)));
+        cache.save(value_type(Integer(2), Matrix<int>(1, 1, 2)));
+        manual_clock::advance(ttl - 1);
+        cache.cleanup();
+        ok = ok && cache.size() == 2;
+        manual_clock::advance(1);
+        cache.cleanup();
+        ok = ok && cache.size() == 0;
+    }
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void random_tester() {
+    //和一个记着写入时刻的表对照：没过期的必须命中且值正确，过期的必须不命中
+    const int ttl = 300;
+    cache_type cache(1000, ms(ttl));
+    std::mt19937 rng(1958);
+    std::unordered_map<int, std::pair<int, long long> > last;
+    bool ok = true;
+    for (int i = 0; i < 50000 && ok; i++) {
+        manual_clock::advance(rng() % 3);
+        long long now = manual_clock::now().time_since_epoch().count();
+        int key = rng() % 500;
+        if (rng() % 3 == 0) {
+            cache.save(value_type(Integer(key), Matrix<int>(1, 1, i)));
+            last[key] = {i, now};
+        } else {
+            Matrix<int> *value = cache.get(Integer(key));
+            auto it = last.find(key);
+            bool alive = it != last.end() && now - it->second.second < ttl;
+            if (alive != (value != nullptr) || (value != nullptr && (*value)[0][0] != it->second.first)) {
+                ok = false;
+            }
+        }
+        if (cache.size() > 500) {
+            ok = false;
+        }
+    }
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void copy_tester() {
+    //原对象析构之后，副本照常save、到期和淘汰
+    cache_type *original = new cache_type(3, ms(100));
+    original->save(value_type(Integer(1), Matrix<int>(1, 1, 1)));
+    manual_clock::advance(50);
+    original->save(value_type(Integer(2), Matrix<int>(1, 1, 2)));
+    cache_type copy(*original);
+    delete original;
+    copy.save(value_type(Integer(3), Matrix<int>(1, 1, 3)));
+    manual_clock::advance(60);
+    copy.cleanup();
+    bool ok = !copy.get(Integer(1)) && copy.get(Integer(2)) && copy.size() == 2;
+    copy.save(value_type(Integer(4), Matrix<int>(1, 1, 4)));
+    copy.save(value_type(Integer(5), Matrix<int>(1, 1, 5)));
+    //2刚被读过，淘汰的是3
+    ok = ok && !copy.get(Integer(3)) && copy.get(Integer(2)) && copy.size() == 3;
+    //赋值之后两边互不影响
+    cache_type other(10, ms(1000));
+    other.save(value_type(Integer(9), Matrix<int>(1, 1, 9)));
+    other = copy;
+    copy.save(value_type(Integer(6), Matrix<int>(1, 1, 6)));
+    ok = ok && !other.get(Integer(9)) && !other.get(Integer(6)) && other.get(Integer(5)) && copy.get(Integer(6));
+    manual_clock::advance(200);
+    other.cleanup();
+    copy.cleanup();
+    ok = ok && other.size() == 0 && copy.size() == 0;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+#ifdef _OUTPUT_
+    freopen("12.out","w",stdout);
+#endif
+    expire_after_write_tester();
+    expire_after_access_tester();
+    batch_reap_tester();
+    long_ttl_tester();
+    random_tester();
+    copy_tester();
+    std::cout << c[8] << std::endl;
+}
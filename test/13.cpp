@@ -0,0 +1,336 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+#include <thread>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: constructor & storage",
+    "test2: copy & move",
+    "test3: add & sub & neg",
+    "test4: multiply",
+    "test5: transpose & pow",
+    "test6: parallel operations",
+    "test7: expression templates",
+    "test8: pow with workspace",
+    "test9: parallel exceptions",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//逐个元素按定义算的乘法，用来对照
+template<typename T>
+Matrix<T> naive_multiply(const Matrix<T> &a, const Matrix<T> &b) {
+    Matrix<T> res(a.RowSize(), b.ColSize(), 0);
+    for (size_t i = 0; i < a.RowSize(); ++i) {
+        for (size_t j = 0; j < b.ColSize(); ++j) {
+            for (size_t k = 0; k < a.ColSize(); ++k) {
+                res[i][j] += a[i][k] * b[k][j];
+            }
+        }
+    }
+    return res;
+}
+
+template<typename T>
+Matrix<T> random_matrix(size_t n, size_t m, std::mt19937 &rng) {
+    Matrix<T> res(n, m);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            res[i][j] = static_cast<T>(static_cast<int>(rng() % 21) - 10);
+        }
+    }
+    return res;
+}
+
+void storage_tester() {
+    //每行首地址连续相差列数个元素，首地址按缓存行对齐
+    Matrix<int> a(3, 5, 7);
+    Matrix<double> b(4, 3);
+    bool ok = a.RowSize() == 3 && a.ColSize() == 5 && a[2][4] == 7 && b[3][2] == 0.0;
+    ok = ok && &a[1][0] == a.Data() + 5 && &a[2][0] == a.Data() + 10;
+    ok = ok && reinterpret_cast<size_t>(a.Data()) % 64 == 0;
+    a[1][2] = 3;
+    ok = ok && a.Data()[7] == 3;
+    Matrix<int> empty;
+    ok = ok && empty.RowSize() == 0 && empty.Data() == nullptr;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void copy_move_tester() {
+    Matrix<int> a(2, 3, 1);
+    a[0][1] = 5;
+    Matrix<int> b(a);
+    b[0][1] = 6;
+    bool ok = a[0][1] == 5 && b[0][1] == 6;
+    Matrix<int> d(3, 2, 9);
+    const int *buffer = d.Data();
+    d = a; //元素个数相同，原地覆盖
+    ok = ok && d.Data() == buffer && d.RowSize() == 2 && d.ColSize() == 3 && d == a;
+    d = Matrix<int>(4, 4, 2);
+    ok = ok && d.RowSize() == 4 && d[3][3] == 2;
+    Matrix<int> e(std::move(d));
+    ok = ok && e[3][3] == 2 && d.Data() == nullptr && d.RowSize() == 0;
+    d = e;
+    ok = ok && d == e;
+    d = d;
+    ok = ok && d == e;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void add_sub_tester() {
+    std::mt19937 rng(2024);
+    Matrix<int> a = random_matrix<int>(7, 9, rng);
+    Matrix<int> b = random_matrix<int>(7, 9, rng);
+    Matrix<int> s = a + b, d = a - b, n = -a, m = -(a + b);
+    bool ok = true;
+    for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 9; ++j) {
+            ok = ok && s[i][j] == a[i][j] + b[i][j] && d[i][j] == a[i][j] - b[i][j] && n[i][j] == -a[i][j] &&
+                 m[i][j] == -s[i][j];
+        }
+    }
+    ok = ok && a * 3 == 3 * a && (a * 2 - a) == a && !(a == b);
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void multiply_tester() {
+    std::mt19937 rng(1958);
+    bool ok = true;
+    const size_t sizes[][3] = {{1, 1, 1}, {2, 3, 4}, {5, 1, 7}, {17, 13, 19}, {33, 64, 31}, {70, 65, 66},
+                                 {65, 300, 47}, {9, 5, 1030}, {130, 257, 67}};
+    for (auto &sz: sizes) {
+        Matrix<int> a = random_matrix<int>(sz[0], sz[1], rng);
+        Matrix<int> b = random_matrix<int>(sz[1], sz[2], rng);
+        ok = ok && a * b == naive_multiply(a, b);
+        Matrix<double> x = random_matrix<double>(sz[0], sz[1], rng);
+        Matrix<double> y = random_matrix<double>(sz[1], sz[2], rng);
+        ok = ok && x * y == naive_multiply(x, y);
+        Matrix<float> u = random_matrix<float>(sz[0], sz[1], rng);
+        Matrix<float> v = random_matrix<float>(sz[1], sz[2], rng);
+        ok = ok && u * v == naive_multiply(u, v);
+        Matrix<long long> p = random_matrix<long long>(sz[0], sz[1], rng);
+        Matrix<long long> q = random_matrix<long long>(sz[1], sz[2], rng);
+        ok = ok && p * q == naive_multiply(p, q);
+    }
+    try {
+        Matrix<int>(2, 3) * Matrix<int>(2, 3);
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void transpose_pow_tester() {
+    std::mt19937 rng(7);
+    Matrix<int> a = random_matrix<int>(6, 4, rng);
+    Matrix<int> t = Transpose(a);
+    bool ok = t.RowSize() == 4 && t.ColSize() == 6 && Transpose(t) == a && t[3][5] == a[5][3];
+    //斐波那契：[[1,1],[1,0]]^n 的右上角是 F(n)
+    Matrix<long long> f(2, 2, 1);
+    f[1][1] = 0;
+    size_t e = 50;
+    ok = ok && Pow(f, e)[0][1] == 12586269025ll;
+    Matrix<int> m = random_matrix<int>(5, 5, rng);
+    e = 5;
+    ok = ok && Pow(m, e) == m * m * m * m * m;
+    e = 0;
+    ok = ok && Pow(m, e) == I<int>(5);
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+    std::cout << Pow(f, e = 10);
+}
+
+void parallel_tester() {
+    //同样的运算分别用单线程和4个工作线程做，结果必须完全一样；两个线程同时算也要对
+    std::mt19937 rng(99);
+    Matrix<int> a = random_matrix<int>(600, 610, rng);
+    Matrix<int> b = random_matrix<int>(600, 610, rng);
+    Matrix<int> x = random_matrix<int>(200, 150, rng);
+    Matrix<int> y = random_matrix<int>(150, 170, rng);
+    Matrix<double> u = random_matrix<double>(130, 260, rng);
+    matrix_kernel::thread_pool::instance().resize(0);
+    Matrix<int> sum = a + b, diff = a - b, neg = -a, scaled = a * 3, t = Transpose(a), prod = x * y;
+    Matrix<double> dprod = u * Transpose(u);
+    matrix_kernel::thread_pool::instance().resize(4);
+    bool ok = matrix_kernel::thread_pool::instance().size() == 5;
+    ok = ok && a + b == sum && a - b == diff && -a == neg && 3 * a == scaled && Transpose(a) == t && x * y == prod;
+    ok = ok && u * Transpose(u) == dprod && prod == naive_multiply(x, y);
+    size_t e = 3;
+    Matrix<int> small = random_matrix<int>(120, 120, rng);
+    ok = ok && Pow(small, e) == naive_multiply(naive_multiply(small, small), small);
+    bool ok1 = true, ok2 = true;
+    std::thread t1([&] {
+        for (int i = 0; i < 5; i++) {
+            ok1 = ok1 && x * y == prod && a + b == sum;
+        }
+    });
+    std::thread t2([&] {
+        for (int i = 0; i < 5; i++) {
+            ok2 = ok2 && x * y == prod && Transpose(a) == t;
+        }
+    });
+    t1.join();
+    t2.join();
+    ok = ok && ok1 && ok2;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void expression_tester() {
+    //整条逐元素的式子一次算完；赋给同样大小的矩阵不重新分配，式子里出现自己也对
+    std::mt19937 rng(3);
+    Matrix<int> a = random_matrix<int>(5, 6, rng);
+    Matrix<int> b = random_matrix<int>(5, 6, rng);
+    Matrix<int> d = random_matrix<int>(5, 6, rng);
+    Matrix<int> r = a + b - d * 2 + -a;
+    bool ok = true;
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            ok = ok && r[i][j] == b[i][j] - d[i][j] * 2;
+        }
+    }
+    const int *buffer = r.Data();
+    r = 3 * (a - b);
+    ok = ok && r.Data() == buffer && r == a * 3 - b * 3;
+    Matrix<int> s = a;
+    s = s + s + b;
+    ok = ok && s == a * 2 + b;
+    s = -(s - b);
+    ok = ok && s == -(a * 2);
+    Matrix<double> x(2, 2, 3.0);
+    Matrix<double> y = x / 2.0 + x;
+    ok = ok && y[1][1] == 4.5;
+    Matrix<int> half = (a * 4) / 2.0;
+    ok = ok && half == a + a;
+    Matrix<int> p = random_matrix<int>(6, 4, rng);
+    ok = ok && (a + b) * p == naive_multiply(Matrix<int>(a + b), p) && Transpose(p) * Transpose(a - b) == naive_multiply(Transpose(p), Transpose(Matrix<int>(a - b)));
+    ok = ok && Transpose(a + b) == Transpose(a) + Transpose(b);
+    Matrix<int> q = random_matrix<int>(3, 3, rng);
+    size_t e = 3;
+    ok = ok && Pow(q + q, e) == (q * q * q) * 8;
+    try {
+        Matrix<int> bad = a + p;
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    ok = ok && !(a + b == a - b + b + b - b + d);
+    std::cout << c[8] << (ok ? c[0] : c[1]) << std::endl;
+    std::cout << Matrix<int>(2, 2, 1) + Matrix<int>(2, 2, 2);
+}
+
+void workspace_pow_tester() {
+    //和逐次相乘的结果对照（无符号，溢出按模回绕）；b 不被修改；同样大小反复求幂时只在工作区的三块内存之间轮换
+    std::mt19937 rng(11);
+    Matrix<unsigned long long> a = random_matrix<unsigned long long>(40, 40, rng);
+    PowWorkspace<unsigned long long> ws;
+    bool ok = true;
+    const unsigned long long *buffers[3] = {nullptr, nullptr, nullptr};
+    for (size_t b: {0, 1, 2, 3, 7, 8, 13}) {
+        Matrix<unsigned long long> expect = I<unsigned long long>(40);
+        for (size_t i = 0; i < b; ++i) {
+            expect = expect * a;
+        }
+        size_t e = b;
+        const Matrix<unsigned long long> &result = Pow(a, e, ws);
+        ok = ok && e == b && result == expect;
+        if (b >= 2) {
+            bool known = false;
+            for (auto &p: buffers) {
+                if (p == result.Data()) {
+                    known = true;
+                } else if (p == nullptr && !known) {
+                    p = result.Data();
+                    known = true;
+                }
+            }
+            ok = ok && known;
+        }
+    }
+    Matrix<int> m = random_matrix<int>(7, 7, rng);
+    PowWorkspace<int> small;
+    size_t e = 5;
+    ok = ok && Pow(m, 5, small) == Pow(m, e) && e == 0;
+    Matrix<int> r = Pow(Pow(m, 2, small), 3, small);
+    e = 6;
+    ok = ok && r == Pow(m, e);
+    //结果可以整块移动出工作区，不拷贝；A 本身不变
+    const int *computed = Pow(m, 3, small).Data();
+    Matrix<int> taken = small.TakeResult();
+    ok = ok && taken.Data() == computed && taken == m * m * m;
+    e = 3;
+    const Matrix<int> before = m;
+    ok = ok && Pow(m, e) == taken && e == 0 && m == before;
+    Matrix<int> out(7, 7);
+    const int *buffer = out.Data();
+    Multiply(m, m, out);
+    ok = ok && out.Data() == buffer && out == m * m;
+    try {
+        Multiply(m, out, out);
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    try {
+        Pow(Matrix<int>(2, 3), 2, small);
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    std::cout << c[9] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void parallel_exception_tester() {
+    //不管哪个线程里抛出，异常都在调用线程重新抛出，线程池之后照常能并行
+    auto &pool = matrix_kernel::thread_pool::instance();
+    pool.resize(3);
+    const size_t n = 64;
+    const size_t cost = matrix_kernel::PARALLEL_WORK; //每行一块
+    std::thread::id caller = std::this_thread::get_id();
+    bool ok = true;
+    for (int from_caller = 0; from_caller < 2; ++from_caller) {
+        std::atomic<size_t> done{0};
+        try {
+            matrix_kernel::parallel_for(n, cost, [&](size_t begin, size_t end) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                if ((std::this_thread::get_id() == caller) == (from_caller == 1)) {
+                    throw std::runtime_error("row failed");
+                }
+                done += end - begin;
+            });
+            ok = false;
+        } catch (std::runtime_error &) {
+        }
+        //出错之后剩下的行不再算
+        ok = ok && done < n;
+    }
+    //调用线程的“在池里”标记已经复位，工作线程也都回来了，新的任务还能分出去
+    std::atomic<size_t> by_caller{0}, by_workers{0};
+    matrix_kernel::parallel_for(n, cost, [&](size_t begin, size_t end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        (std::this_thread::get_id() == caller ? by_caller : by_workers) += end - begin;
+    });
+    ok = ok && by_caller + by_workers == n && by_caller > 0 && by_workers > 0;
+    //乘法的结果不受影响
+    std::mt19937 rng(5);
+    Matrix<int> x = random_matrix<int>(300, 200, rng);
+    Matrix<int> y = random_matrix<int>(200, 1100, rng);
+    ok = ok && x * y == naive_multiply(x, y);
+    std::cout << c[10] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+#ifdef _OUTPUT_
+    freopen("13.out","w",stdout);
+#endif
+    storage_tester();
+    copy_move_tester();
+    add_sub_tester();
+    multiply_tester();
+    transpose_pow_tester();
+    parallel_tester();
+    expression_tester();
+    workspace_pow_tester();
+    parallel_exception_tester();
+    std::cout << c[11] << std::endl;
+}
@@ -0,0 +1,312 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: pair forwarding & piecewise",
+    "test2: hashmap insert rvalue & try_emplace",
+    "test3: flat hashmap insert rvalue & try_emplace",
+    "test4: linked_hashmap emplace & try_emplace",
+    "test5: lru emplace matrix in place",
+    "test6: random emplace & save",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//记录构造、拷贝、移动次数的值类型
+struct Counted {
+    static inline int constructed = 0, copied = 0, moved = 0;
+    int val;
+
+    explicit Counted(int v = 0) : val(v) {
+        ++constructed;
+    }
+
+    Counted(int a, int b) : val(a * b) {
+        ++constructed;
+    }
+
+    Counted(const Counted &other) : val(other.val) {
+        ++copied;
+    }
+
+    Counted(Counted &&other) noexcept : val(other.val) {
+        ++moved;
+    }
+
+    Counted &operator=(const Counted &other) {
+        val = other.val;
+        ++copied;
+        return *this;
+    }
+
+    Counted &operator=(Counted &&other) noexcept {
+        val = other.val;
+        ++moved;
+        return *this;
+    }
+
+    static void reset() {
+        constructed = copied = moved = 0;
+    }
+};
+
+//只能移动的值类型
+struct MoveOnly {
+    int *p;
+
+    explicit MoveOnly(int v) : p(new int(v)) {
+    }
+
+    MoveOnly(const MoveOnly &) = delete;
+
+    MoveOnly &operator=(const MoveOnly &) = delete;
+
+    MoveOnly(MoveOnly &&other) noexcept : p(other.p) {
+        other.p = nullptr;
+    }
+
+    MoveOnly &operator=(MoveOnly &&other) noexcept {
+        std::swap(p, other.p);
+        return *this;
+    }
+
+    ~MoveOnly() {
+        delete p;
+    }
+};
+
+struct IntHash {
+    size_t operator()(int x) const {
+        return static_cast<size_t>(x) * 2654435761u;
+    }
+};
+
+struct IntEqual {
+    bool operator()(int a, int b) const {
+        return a == b;
+    }
+};
+
+void pair_tester() {
+    bool ok = true;
+    Counted::reset();
+    sjtu::pair<int, Counted> a(1, Counted(7));
+    ok = ok && Counted::copied == 0 && Counted::moved == 1 && a.second.val == 7;
+    sjtu::pair<const int, Counted> b(std::move(a));
+    ok = ok && Counted::copied == 0 && Counted::moved == 2 && b.first == 1;
+    sjtu::pair<const int, Counted> d(std::piecewise_construct, std::forward_as_tuple(2), std::forward_as_tuple(3, 4));
+    ok = ok && Counted::copied == 0 && Counted::moved == 2 && Counted::constructed == 2 && d.second.val == 12;
+    sjtu::pair<int, MoveOnly> e(3, MoveOnly(5));
+    sjtu::pair<int, MoveOnly> f(std::move(e));
+    ok = ok && e.second.p == nullptr && *f.second.p == 5;
+    sjtu::pair<int, Matrix<int> > g(std::piecewise_construct, std::forward_as_tuple(4), std::forward_as_tuple(2, 3, 9));
+    ok = ok && g.second.RowSize() == 2 && g.second.ColSize() == 3 && g.second[1][2] == 9;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+template<class Storage>
+bool hashmap_check() {
+    bool ok = true;
+    sjtu::hashmap<int, Counted, IntHash, IntEqual, Storage> map;
+    using value_type = sjtu::pair<const int, Counted>;
+    Counted::reset();
+    for (int i = 0; i < 100; ++i) {
+        map.insert(value_type(i, Counted(i)));
+    }
+    ok = ok && Counted::copied == 0;
+    //已存在时移动赋值
+    map.insert(value_type(5, Counted(50)));
+    ok = ok && Counted::copied == 0 && map.find(5)->second.val == 50;
+    //try_emplace：不存在时原地构造，不产生拷贝（开放寻址扩容时会移动已有元素）
+    Counted::reset();
+    for (int i = 100; i < 200; ++i) {
+        ok = ok && map.try_emplace(i, i, 2).second;
+    }
+    ok = ok && Counted::copied == 0 && Counted::constructed == 100;
+    //已存在时什么都不做，参数不被移动
+    Counted spare(99);
+    Counted::reset();
+    auto result = map.try_emplace(150, std::move(spare));
+    ok = ok && !result.second && result.first->second.val == 300 && Counted::moved == 0;
+    //operator[]不覆盖已有值
+    ok = ok && map[150].val == 300 && map[1000].val == 0;
+    map.emplace(7, Counted(70));
+    ok = ok && map.find(7)->second.val == 70;
+    for (int i = 0; i < 200; ++i) {
+        ok = ok && map.find(i) != map.end();
+    }
+    //只能移动的值
+    sjtu::hashmap<int, MoveOnly, IntHash, IntEqual, Storage> moves;
+    for (int i = 0; i < 50; ++i) {
+        moves.try_emplace(i, i);
+    }
+    moves.insert(sjtu::pair<const int, MoveOnly>(3, MoveOnly(30)));
+    ok = ok && *moves.find(3)->second.p == 30 && *moves.find(49)->second.p == 49;
+    return ok;
+}
+
+void hashmap_tester() {
+    bool ok = hashmap_check<sjtu::chained_buckets>();
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void flat_hashmap_tester() {
+    bool ok = hashmap_check<sjtu::flat_buckets>();
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void linked_hashmap_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<int, Counted, IntHash, IntEqual> map;
+    Counted::reset();
+    for (int i = 0; i < 10; ++i) {
+        map.try_emplace(i, i);
+    }
+    ok = ok && Counted::copied == 0 && Counted::moved == 0;
+    //try_emplace已存在的键：值和顺序都不变
+    auto result = map.try_emplace(0, 100);
+    ok = ok && !result.second && result.first->second.val == 0 && map.begin()->first == 0;
+    //emplace已存在的键：更新值并移到尾部
+    map.emplace(0, Counted(100));
+    ok = ok && map.begin()->first == 1 && map.at(0).val == 100 && Counted::copied == 0;
+    int expect[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0};
+    int pos = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        ok = ok && it->first == expect[pos++];
+    }
+    sjtu::linked_hashmap<int, MoveOnly, IntHash, IntEqual> moves;
+    for (int i = 0; i < 50; ++i) {
+        moves.insert(sjtu::pair<const int, MoveOnly>(i, MoveOnly(i)));
+    }
+    moves.try_emplace(60, 60);
+    ok = ok && moves.size() == 51 && *moves.at(60).p == 60 && *moves.at(10).p == 10;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void lru_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(3);
+    //矩阵直接在节点里按(行,列,初值)构造
+    for (int i = 0; i < 5; ++i) {
+        auto result = cache.try_emplace(Integer(i), 2, 2, i);
+        ok = ok && result.second && (*result.first)[1][1] == i;
+    }
+    ok = ok && cache.size() == 3 && !cache.get(Integer(0)) && !cache.get(Integer(1));
+    //try_emplace已存在：不替换，但算一次访问
+    auto result = cache.try_emplace(Integer(2), 5, 5, 0);
+    ok = ok && !result.second && result.first->RowSize() == 2;
+    cache.try_emplace(Integer(5), 1, 1, 5);
+    ok = ok && cache.get(Integer(2)) && !cache.get(Integer(3));
+    //emplace已存在：替换
+    Matrix<int> *m = cache.emplace(Integer(2), 3, 4, 7);
+    ok = ok && m == cache.get(Integer(2)) && m->RowSize() == 3 && (*m)[2][3] == 7;
+    //右值save
+    Matrix<int> big(10, 10, 1);
+    cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(6), std::move(big)));
+    ok = ok && cache.get(Integer(6)) && (*cache.get(Integer(6)))[9][9] == 1 && cache.size() == 3;
+
+    sjtu::lru<int, Counted, IntHash, IntEqual> counted(2);
+    Counted::reset();
+    counted.try_emplace(1, 1);
+    counted.emplace(2, 2);
+    counted.emplace(2, 3, 4);
+    counted.save(sjtu::pair<const int, Counted>(3, Counted(3)));
+    ok = ok && Counted::copied == 0 && counted.get(2)->val == 12 && !counted.get(1);
+
+    sjtu::lru<int, Counted, IntHash, IntEqual> none(0);
+    ok = ok && none.emplace(1, 1) == nullptr && none.try_emplace(1, 1).first == nullptr && none.size() == 0;
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void random_tester() {
+    bool ok = true;
+    std::mt19937 rng(19260817);
+    const int cap = 64;
+    sjtu::lru<int, Counted, IntHash, IntEqual> cache(cap);
+    //朴素的参照实现：数组模拟LRU顺序
+    int keys[cap], vals[cap], n = 0;
+    auto locate = [&](int key) {
+        for (int i = 0; i < n; ++i) {
+            if (keys[i] == key) {
+                return i;
+            }
+        }
+        return -1;
+    };
+    auto to_back = [&](int i) {
+        int k = keys[i], v = vals[i];
+        for (int j = i; j + 1 < n; ++j) {
+            keys[j] = keys[j + 1];
+            vals[j] = vals[j + 1];
+        }
+        keys[n - 1] = k;
+        vals[n - 1] = v;
+    };
+    auto push = [&](int key, int val) {
+        if (n == cap) {
+            for (int j = 0; j + 1 < n; ++j) {
+                keys[j] = keys[j + 1];
+                vals[j] = vals[j + 1];
+            }
+            --n;
+        }
+        keys[n] = key;
+        vals[n++] = val;
+    };
+    for (int step = 0; step < 20000 && ok; ++step) {
+        int key = rng() % 200, val = rng() % 1000, op = rng() % 4;
+        int i = locate(key);
+        if (op == 0) {
+            cache.emplace(key, val);
+            if (i >= 0) {
+                vals[i] = val;
+                to_back(i);
+            } else {
+                push(key, val);
+            }
+        } else if (op == 1) {
+            auto result = cache.try_emplace(key, val);
+            ok = ok && result.second == (i < 0);
+            if (i >= 0) {
+                ok = ok && result.first->val == vals[i];
+                to_back(i);
+            } else {
+                push(key, val);
+            }
+        } else if (op == 2) {
+            cache.save(sjtu::pair<const int, Counted>(key, Counted(val)));
+            if (i >= 0) {
+                vals[i] = val;
+                to_back(i);
+            } else {
+                push(key, val);
+            }
+        } else {
+            Counted *got = cache.get(key);
+            ok = ok && (got != nullptr) == (i >= 0);
+            if (i >= 0) {
+                ok = ok && got->val == vals[i];
+                to_back(i);
+            }
+        }
+        ok = ok && cache.size() == static_cast<size_t>(n);
+    }
+    ok = ok && Counted::copied == 0;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    pair_tester();
+    hashmap_tester();
+    flat_hashmap_tester();
+    linked_hashmap_tester();
+    lru_tester();
+    random_tester();
+    std::cout << c[8] << std::endl;
+}
@@ -0,0 +1,131 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: hashmap hashes each key once",
+    "test2: hashmap compares only on hash match",
+    "test3: linked_hashmap hashes each key once",
+    "test4: linked_hashmap compares only on hash match",
+    "test5: random insert & remove with collisions",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+long long hash_calls = 0, equal_calls = 0;
+
+//计数的哈希，乘以1024让低位全为0，桶数不超过1024时所有键都落在同一个桶里
+struct CountingHash {
+    size_t operator()(int x) const {
+        ++hash_calls;
+        return static_cast<size_t>(x) << 10;
+    }
+};
+
+struct CountingEqual {
+    bool operator()(int a, int b) const {
+        ++equal_calls;
+        return a == b;
+    }
+};
+
+void reset() {
+    hash_calls = equal_calls = 0;
+}
+
+template<class Map>
+bool hash_once_check() {
+    const int n = 20000;
+    Map map;
+    reset();
+    for (int i = 0; i < n; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i));
+    }
+    //每次插入只哈希一次，扩容和搬迁用缓存的哈希值
+    bool ok = hash_calls == n;
+    Map copy(map);
+    ok = ok && hash_calls == n && copy.size() == static_cast<size_t>(n);
+    return ok;
+}
+
+template<class Map>
+bool compare_check() {
+    const int n = 500;
+    Map map;
+    for (int i = 0; i < n; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i));
+    }
+    reset();
+    bool ok = true;
+    for (int i = 0; i < n; ++i) {
+        ok = ok && map.count(i) == 1;
+    }
+    for (int i = n; i < 2 * n; ++i) {
+        ok = ok && map.count(i) == 0;
+    }
+    //同桶的键很多，但每次命中只比较一次，未命中不比较
+    return ok && equal_calls == n && hash_calls == 2 * n;
+}
+
+//hashmap没有size和count，包一层统一接口
+struct chained_map : sjtu::hashmap<int, int, CountingHash, CountingEqual> {
+    size_t n = 0;
+
+    void insert(const sjtu::pair<const int, int> &v) {
+        n += sjtu::hashmap<int, int, CountingHash, CountingEqual>::insert(v).second;
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    size_t count(int key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+};
+
+using linked_map = sjtu::linked_hashmap<int, int, CountingHash, CountingEqual>;
+
+void random_tester() {
+    std::mt19937 rng(20240607);
+    chained_map map;
+    linked_map linked;
+    bool present[4096] = {};
+    bool ok = true;
+    for (int step = 0; step < 50000 && ok; ++step) {
+        int key = rng() % 4096;
+        if (rng() % 3 == 0) {
+            bool removed = map.remove(key);
+            ok = ok && removed == present[key];
+            if (present[key]) {
+                linked.remove(linked.find(key));
+                --map.n;
+            }
+            present[key] = false;
+        } else {
+            map.insert(sjtu::pair<const int, int>(key, step));
+            linked.insert(sjtu::pair<const int, int>(key, step));
+            present[key] = true;
+        }
+        ok = ok && (map.count(key) == 1) == present[key] && (linked.count(key) == 1) == present[key];
+    }
+    for (int key = 0; key < 4096; ++key) {
+        ok = ok && (map.count(key) == 1) == present[key] && (linked.count(key) == 1) == present[key];
+    }
+    ok = ok && map.size() == linked.size();
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    std::cout << c[2] << (hash_once_check<chained_map>() ? c[0] : c[1]) << std::endl;
+    std::cout << c[3] << (compare_check<chained_map>() ? c[0] : c[1]) << std::endl;
+    std::cout << c[4] << (hash_once_check<linked_map>() ? c[0] : c[1]) << std::endl;
+    std::cout << c[5] << (compare_check<linked_map>() ? c[0] : c[1]) << std::endl;
+    random_tester();
+    std::cout << c[7] << std::endl;
+}
@@ -0,0 +1,151 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: hashmap reserve & rehash",
+    "test2: flat hashmap reserve & rehash",
+    "test3: linked_hashmap reserve & rehash",
+    "test4: max_load_factor",
+    "test5: lru presized for capacity",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//reserve(n)之后插入n个元素桶数不变，之后rehash不丢元素
+template<class Map>
+bool reserve_check() {
+    const int n = 50000;
+    bool ok = true;
+    Map map;
+    map.reserve(n);
+    size_t buckets = map.bucket_count();
+    ok = ok && static_cast<double>(n) / buckets <= map.max_load_factor();
+    for (int i = 0; i < n; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i * 3));
+    }
+    ok = ok && map.bucket_count() == buckets && map.size() == static_cast<size_t>(n);
+    ok = ok && map.load_factor() <= map.max_load_factor();
+    //rehash(0)按当前元素收缩到刚好满足负载因子，rehash(大数)扩大
+    map.rehash(0);
+    ok = ok && map.bucket_count() <= buckets && map.load_factor() <= map.max_load_factor();
+    map.rehash(4 * buckets);
+    ok = ok && map.bucket_count() >= 4 * buckets;
+    for (int i = 0; i < n; ++i) {
+        auto it = map.find(i);
+        ok = ok && it != map.end() && it->second == i * 3;
+    }
+    ok = ok && map.find(n) == map.end();
+    return ok;
+}
+
+void hashmap_tester() {
+    bool ok = reserve_check<sjtu::hashmap<int, int> >();
+    //搬迁进行到一半时rehash也要先搬完
+    sjtu::hashmap<int, int> map;
+    for (int i = 0; i < 33; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i));
+    }
+    ok = ok && map.rehashing();
+    map.rehash(1000);
+    ok = ok && !map.rehashing() && map.bucket_count() == 1000;
+    for (int i = 0; i < 33; ++i) {
+        ok = ok && map.find(i) != map.end();
+    }
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void flat_hashmap_tester() {
+    using mp = sjtu::hashmap<int, int, std::hash<int>, std::equal_to<int>, sjtu::flat_buckets>;
+    bool ok = reserve_check<mp>();
+    //槽数总是16乘以2的幂
+    mp map;
+    map.rehash(100);
+    ok = ok && map.bucket_count() == 128;
+    map.reserve(1000);
+    ok = ok && map.bucket_count() == 2048;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void linked_hashmap_tester() {
+    using mp = sjtu::linked_hashmap<int, int>;
+    bool ok = reserve_check<mp>();
+    //rehash不改变插入顺序
+    mp map;
+    for (int i = 0; i < 100; ++i) {
+        map.insert(sjtu::pair<const int, int>(99 - i, i));
+    }
+    map.rehash(7);
+    int expect = 99;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        ok = ok && it->first == expect--;
+    }
+    ok = ok && expect == -1;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void max_load_factor_tester() {
+    bool ok = true;
+    sjtu::hashmap<int, int> chained;
+    sjtu::linked_hashmap<int, int> linked;
+    sjtu::hashmap<int, int, std::hash<int>, std::equal_to<int>, sjtu::flat_buckets> flat;
+    for (int i = 0; i < 1000; ++i) {
+        chained.insert(sjtu::pair<const int, int>(i, i));
+        linked.insert(sjtu::pair<const int, int>(i, i));
+        flat.insert(sjtu::pair<const int, int>(i, i));
+    }
+    //调低时立刻重建
+    chained.max_load_factor(0.25);
+    linked.max_load_factor(0.25);
+    flat.max_load_factor(0.25);
+    ok = ok && chained.load_factor() <= 0.25 && linked.load_factor() <= 0.25 && flat.load_factor() <= 0.25;
+    //调高后继续插入，负载因子可以超过默认值
+    linked.max_load_factor(4);
+    linked.rehash(0);
+    ok = ok && linked.load_factor() > 0.75 && linked.load_factor() <= 4;
+    for (int i = 1000; i < 5000; ++i) {
+        linked.insert(sjtu::pair<const int, int>(i, i));
+    }
+    ok = ok && linked.load_factor() <= 4 && linked.load_factor() > 1 && linked.size() == 5000;
+    //开放寻址不能超过0.875
+    flat.max_load_factor(2);
+    ok = ok && flat.max_load_factor() == 0.875;
+    bool thrown = false;
+    try {
+        chained.max_load_factor(0);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    ok = ok && thrown;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void lru_tester() {
+    bool ok = true;
+    const int capacity = 1000;
+    sjtu::lru<> cache(capacity);
+    size_t buckets = cache.bucket_count();
+    ok = ok && static_cast<double>(capacity + 1) / buckets <= cache.max_load_factor();
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; ++i) {
+        int key = rng() % 3000;
+        cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(key), Matrix<int>(1, 1, key)));
+        ok = ok && cache.bucket_count() == buckets;
+    }
+    ok = ok && cache.size() == capacity && cache.load_factor() <= cache.max_load_factor();
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    hashmap_tester();
+    flat_hashmap_tester();
+    linked_hashmap_tester();
+    max_load_factor_tester();
+    lru_tester();
+    std::cout << c[7] << std::endl;
+}
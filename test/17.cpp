@@ -0,0 +1,178 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <random>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: lru get by int",
+    "test2: hashmap find/count/remove by int",
+    "test3: flat hashmap find/count/remove by int",
+    "test4: linked_hashmap & string_view keys",
+    "test5: no key constructed on lookup",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//透明的字符串哈希和比较，std::string和std::string_view都走string_view的哈希
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const {
+        return std::hash<std::string_view>()(s);
+    }
+};
+
+struct StringEqual {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const {
+        return a == b;
+    }
+};
+
+//记录构造次数的键
+struct Tracked {
+    static inline int constructed = 0;
+    int val;
+
+    Tracked(int v) : val(v) {
+        ++constructed;
+    }
+
+    Tracked(const Tracked &other) : val(other.val) {
+        ++constructed;
+    }
+};
+
+struct TrackedHash {
+    using is_transparent = void;
+
+    size_t operator()(const Tracked &t) const {
+        return std::hash<int>()(t.val);
+    }
+
+    size_t operator()(int v) const {
+        return std::hash<int>()(v);
+    }
+};
+
+struct TrackedEqual {
+    using is_transparent = void;
+
+    bool operator()(const Tracked &a, const Tracked &b) const {
+        return a.val == b.val;
+    }
+
+    bool operator()(const Tracked &a, int b) const {
+        return a.val == b;
+    }
+};
+
+void lru_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(10);
+    for (int i = 0; i < 20; ++i) {
+        cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    for (int i = 0; i < 20; ++i) {
+        Matrix<int> *m = cache.get(i);
+        ok = ok && (i < 10 ? m == nullptr : m != nullptr && (*m)[0][0] == i);
+    }
+    //按int命中同样会更新最近使用顺序
+    cache.get(10);
+    cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(100), Matrix<int>(1, 1, 100)));
+    ok = ok && cache.get(10) != nullptr && cache.get(11) == nullptr && cache.get(Integer(100)) != nullptr;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+template<class Storage>
+bool hashmap_check() {
+    bool ok = true;
+    sjtu::hashmap<Integer, int, Hash, Equal, Storage> map;
+    for (int i = 0; i < 1000; ++i) {
+        map.insert(sjtu::pair<const Integer, int>(Integer(i), i * 2));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        auto it = map.find(i);
+        ok = ok && it != map.end() && it->second == i * 2 && map.count(i) == 1;
+    }
+    ok = ok && map.count(1000) == 0 && map.find(-1) == map.end();
+    for (int i = 0; i < 1000; i += 2) {
+        ok = ok && map.remove(i);
+    }
+    ok = ok && !map.remove(0) && map.size() == 500;
+    for (int i = 0; i < 1000; ++i) {
+        ok = ok && map.count(i) == static_cast<size_t>(i % 2);
+    }
+    return ok;
+}
+
+void hashmap_tester() {
+    bool ok = hashmap_check<sjtu::chained_buckets>();
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void flat_hashmap_tester() {
+    bool ok = hashmap_check<sjtu::flat_buckets>();
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void string_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<std::string, int, StringHash, StringEqual> map;
+    std::string words[] = {"alpha", "beta", "gamma", "a rather long key that does not fit in sso"};
+    for (int i = 0; i < 4; ++i) {
+        map.insert(sjtu::pair<const std::string, int>(words[i], i));
+    }
+    std::string_view view = words[3];
+    ok = ok && map.find(view) != map.end() && map.find(view)->second == 3;
+    ok = ok && map.count(std::string_view("beta")) == 1 && map.count(std::string_view("delta")) == 0;
+    ok = ok && map.find(std::string("gamma"))->second == 2;
+
+    sjtu::lru<std::string, int, StringHash, StringEqual> cache(2);
+    cache.save(sjtu::pair<const std::string, int>("x", 1));
+    cache.save(sjtu::pair<const std::string, int>("y", 2));
+    ok = ok && cache.get(std::string_view("x")) && *cache.get(std::string_view("x")) == 1;
+    cache.save(sjtu::pair<const std::string, int>("z", 3));
+    ok = ok && !cache.get(std::string_view("y")) && cache.get(std::string_view("z"));
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void construct_tester() {
+    bool ok = true;
+    sjtu::hashmap<Tracked, int, TrackedHash, TrackedEqual> chained;
+    sjtu::hashmap<Tracked, int, TrackedHash, TrackedEqual, sjtu::flat_buckets> flat;
+    sjtu::lru<Tracked, int, TrackedHash, TrackedEqual> cache(64);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 100; ++i) {
+        chained.try_emplace(Tracked(i), i);
+        flat.try_emplace(Tracked(i), i);
+        cache.try_emplace(Tracked(i), i);
+    }
+    Tracked::constructed = 0;
+    int hits = 0;
+    for (int i = 0; i < 10000; ++i) {
+        int key = rng() % 200;
+        hits += chained.count(key) + flat.count(key) + (cache.get(key) != nullptr);
+    }
+    for (int i = 0; i < 100; i += 3) {
+        chained.remove(i);
+        flat.remove(i);
+    }
+    ok = ok && Tracked::constructed == 0 && hits > 0;
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    lru_tester();
+    hashmap_tester();
+    flat_hashmap_tester();
+    string_tester();
+    construct_tester();
+    std::cout << c[7] << std::endl;
+}
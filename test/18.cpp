@@ -0,0 +1,171 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+#include <vector>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: hashmap find_many",
+    "test2: flat hashmap find_many",
+    "test3: linked_hashmap find_many",
+    "test4: lru get_many & save_many match get & save",
+    "test5: lru get_many on matrices",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+struct IntHash {
+    size_t operator()(int x) const {
+        return static_cast<size_t>(x) * 2654435761u;
+    }
+};
+
+struct IntEqual {
+    bool operator()(int a, int b) const {
+        return a == b;
+    }
+};
+
+using value_type = sjtu::pair<const int, int>;
+
+//find_many的结果和逐个find一致；不同长度（不满一批、正好一批、多批）都要测
+template<class Map>
+bool find_many_check(Map &map, std::mt19937 &rng) {
+    bool ok = true;
+    for (size_t len: {0, 1, 15, 16, 17, 100, 1000}) {
+        std::vector<int> keys(len);
+        for (auto &key: keys) {
+            key = rng() % 4000;
+        }
+        std::vector<typename Map::iterator> out(len);
+        map.find_many(keys, out);
+        for (size_t i = 0; i < len; ++i) {
+            ok = ok && out[i] == map.find(keys[i]);
+        }
+    }
+    bool thrown = false;
+    std::vector<int> keys(3);
+    std::vector<typename Map::iterator> out(2);
+    try {
+        map.find_many(keys, out);
+    } catch (std::invalid_argument &) {
+        thrown = true;
+    }
+    return ok && thrown;
+}
+
+template<class Storage>
+bool hashmap_check() {
+    std::mt19937 rng(3);
+    sjtu::hashmap<int, int, IntHash, IntEqual, Storage> map;
+    bool ok = true;
+    //边插边查，链式的表会在渐进式搬迁中途被查到
+    for (int i = 0; i < 2000; ++i) {
+        map.insert(value_type(static_cast<int>(rng() % 4000), i));
+        if (i % 97 == 0) {
+            ok = ok && find_many_check(map, rng);
+        }
+    }
+    return ok && find_many_check(map, rng);
+}
+
+void hashmap_tester() {
+    bool ok = hashmap_check<sjtu::chained_buckets>();
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void flat_hashmap_tester() {
+    bool ok = hashmap_check<sjtu::flat_buckets>();
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void linked_hashmap_tester() {
+    std::mt19937 rng(5);
+    sjtu::linked_hashmap<int, int, IntHash, IntEqual> map;
+    bool ok = true;
+    for (int i = 0; i < 2000; ++i) {
+        map.insert(value_type(static_cast<int>(rng() % 4000), i));
+        if (i % 97 == 0) {
+            ok = ok && find_many_check(map, rng);
+        }
+    }
+    ok = ok && find_many_check(map, rng);
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void lru_tester() {
+    std::mt19937 rng(7);
+    const int capacity = 300;
+    sjtu::lru<int, int, IntHash, IntEqual> batched(capacity), single(capacity);
+    bool ok = true;
+    for (int round = 0; round < 200 && ok; ++round) {
+        size_t len = rng() % 200;
+        if (rng() % 2 == 0) {
+            //批量写里可能有重复的键，也可能一批就超过容量
+            std::vector<value_type> values;
+            for (size_t i = 0; i < len; ++i) {
+                values.emplace_back(static_cast<int>(rng() % 1000), round * 1000 + static_cast<int>(i));
+            }
+            batched.save_many(values);
+            for (auto &v: values) {
+                single.save(v);
+            }
+        } else {
+            std::vector<int> keys(len);
+            for (auto &key: keys) {
+                key = rng() % 1000;
+            }
+            std::vector<int *> out(len);
+            size_t hits = batched.get_many(keys, out);
+            size_t expect = 0;
+            for (size_t i = 0; i < len; ++i) {
+                int *got = single.get(keys[i]);
+                expect += got != nullptr;
+                ok = ok && (got == nullptr) == (out[i] == nullptr) && (got == nullptr || *got == *out[i]);
+            }
+            ok = ok && hits == expect;
+        }
+        ok = ok && batched.size() == single.size();
+    }
+    //最后逐个比较全部内容
+    for (int key = 0; key < 1000; ++key) {
+        int *a = batched.get(key), *b = single.get(key);
+        ok = ok && (a == nullptr) == (b == nullptr) && (a == nullptr || *a == *b);
+    }
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void matrix_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(50);
+    std::vector<sjtu::pair<const Integer, Matrix<int> > > values;
+    for (int i = 0; i < 60; ++i) {
+        values.emplace_back(Integer(i), Matrix<int>(2, 2, i));
+    }
+    cache.save_many(values);
+    std::vector<Integer> keys;
+    for (int i = 0; i < 60; i += 3) {
+        keys.emplace_back(i);
+    }
+    std::vector<Matrix<int> *> out(keys.size());
+    size_t hits = cache.get_many(keys, out);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        int key = keys[i].val;
+        ok = ok && (key < 10 ? out[i] == nullptr : out[i] != nullptr && (*out[i])[1][1] == key);
+    }
+    ok = ok && hits == 16 && cache.size() == 50;
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    hashmap_tester();
+    flat_hashmap_tester();
+    linked_hashmap_tester();
+    lru_tester();
+    matrix_tester();
+    std::cout << c[7] << std::endl;
+}
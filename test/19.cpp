@@ -0,0 +1,152 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: lru get_or_load",
+    "test2: concurrent misses load once",
+    "test3: loader exception reaches every waiter",
+    "test4: different keys load in parallel",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//Integer的计数器不是原子的，多线程测试用int作键
+struct IntHash {
+    size_t operator()(int x) const {
+        return static_cast<size_t>(x) * 2654435761u;
+    }
+};
+
+struct IntEqual {
+    bool operator()(int a, int b) const {
+        return a == b;
+    }
+};
+
+using cache_type = sjtu::concurrent_lru<int, Matrix<int>, IntHash, IntEqual>;
+
+void lru_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(2);
+    int calls = 0;
+    auto loader = [&calls](const Integer &key) {
+        ++calls;
+        return Matrix<int>(2, 2, key.val);
+    };
+    Matrix<int> *a = cache.get_or_load(Integer(1), loader);
+    Matrix<int> *b = cache.get_or_load(Integer(1), loader);
+    ok = ok && a == b && calls == 1 && (*a)[1][1] == 1;
+    cache.get_or_load(Integer(2), loader);
+    //1刚被访问过，再加载3时淘汰的是2
+    cache.get_or_load(Integer(1), loader);
+    cache.get_or_load(Integer(3), loader);
+    ok = ok && calls == 3 && cache.get(Integer(1)) && !cache.get(Integer(2));
+    //loader抛异常时什么都不存
+    bool thrown = false;
+    try {
+        cache.get_or_load(Integer(4), [](const Integer &) -> Matrix<int> { throw std::runtime_error("load"); });
+    } catch (std::runtime_error &) {
+        thrown = true;
+    }
+    ok = ok && thrown && !cache.get(Integer(4)) && cache.size() == 2;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void single_flight_tester() {
+    bool ok = true;
+    cache_type cache(64, 4);
+    std::atomic<int> calls{0};
+    const int threads = 8;
+    std::vector<Matrix<int> > results(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            results[t] = cache.get_or_load(7, [&calls](int key) {
+                ++calls;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return Matrix<int>(3, 3, key);
+            });
+        });
+    }
+    for (auto &w: workers) {
+        w.join();
+    }
+    ok = ok && calls == 1;
+    for (int t = 0; t < threads; ++t) {
+        ok = ok && results[t].RowSize() == 3 && results[t][2][2] == 7;
+    }
+    Matrix<int> stored(1, 1);
+    ok = ok && cache.get(7, stored) && stored[0][0] == 7;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void exception_tester() {
+    bool ok = true;
+    cache_type cache(64, 4);
+    std::atomic<int> calls{0}, failures{0};
+    const int threads = 6;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            try {
+                cache.get_or_load(9, [&calls](int) -> Matrix<int> {
+                    ++calls;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    throw std::runtime_error("load failed");
+                });
+            } catch (std::runtime_error &) {
+                ++failures;
+            }
+        });
+    }
+    for (auto &w: workers) {
+        w.join();
+    }
+    //失败之后不留状态，下一次重新加载
+    Matrix<int> later = cache.get_or_load(9, [](int key) { return Matrix<int>(1, 1, key); });
+    ok = ok && calls == 1 && failures == threads && later[0][0] == 9 && cache.size() == 1;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void parallel_keys_tester() {
+    bool ok = true;
+    cache_type cache(64, 1);
+    std::atomic<int> calls{0};
+    const int threads = 4;
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            cache.get_or_load(t, [&calls](int key) {
+                ++calls;
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                return Matrix<int>(1, 1, key);
+            });
+        });
+    }
+    for (auto &w: workers) {
+        w.join();
+    }
+    //同一个分片上的不同键，加载在锁外进行，互不等待
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ok = ok && calls == threads && cache.size() == threads && elapsed < std::chrono::milliseconds(700);
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    lru_tester();
+    single_flight_tester();
+    exception_tester();
+    parallel_keys_tester();
+    std::cout << c[6] << std::endl;
+}
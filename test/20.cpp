@@ -0,0 +1,207 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: no refresh before threshold",
+    "test2: stale get returns at once, reload in background",
+    "test3: refresh keeps lru order",
+    "test4: save during refresh wins",
+    "test5: failed refresh keeps old value",
+    "test6: save during refresh queues no second refresh",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//测试用的假时钟，后台线程也会读，所以用原子变量
+struct manual_clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<manual_clock>;
+    static constexpr bool is_steady = true;
+    static inline std::atomic<long long> current{0};
+
+    static time_point now() {
+        return time_point(duration(current.load()));
+    }
+
+    static void advance(long long ms) {
+        current += ms;
+    }
+};
+
+//Integer的计数器不是原子的，多线程测试用int作键
+struct IntHash {
+    size_t operator()(int x) const {
+        return static_cast<size_t>(x) * 2654435761u;
+    }
+};
+
+struct IntEqual {
+    bool operator()(int a, int b) const {
+        return a == b;
+    }
+};
+
+using cache_type = sjtu::refreshing_lru<int, Matrix<int>, IntHash, IntEqual, manual_clock>;
+using value_type = sjtu::pair<const int, Matrix<int> >;
+using ms = std::chrono::milliseconds;
+
+//每次加载的值为 键*1000+第几次加载
+std::atomic<int> loads{0};
+
+Matrix<int> loader(int key) {
+    return Matrix<int>(1, 1, key * 1000 + ++loads);
+}
+
+void threshold_tester() {
+    loads = 0;
+    cache_type cache(10, ms(100), loader);
+    cache.save(value_type(1, Matrix<int>(1, 1, 1)));
+    Matrix<int> out;
+    manual_clock::advance(99);
+    bool ok = cache.get(1, out) && out[0][0] == 1;
+    cache.drain();
+    ok = ok && loads == 0 && !cache.get(2, out);
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void refresh_tester() {
+    loads = 0;
+    std::atomic<bool> release{false};
+    cache_type cache(10, ms(100), [&release](int key) {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return loader(key);
+    });
+    cache.save(value_type(1, Matrix<int>(1, 1, 1)));
+    manual_clock::advance(150);
+    Matrix<int> out;
+    //loader还卡着，get也照样立刻返回旧值；多次get只排一次刷新
+    bool ok = true;
+    for (int i = 0; i < 5; ++i) {
+        ok = ok && cache.get(1, out) && out[0][0] == 1;
+    }
+    release = true;
+    cache.drain();
+    ok = ok && loads == 1 && cache.get(1, out) && out[0][0] == 1001;
+    //刷新后重新计时
+    manual_clock::advance(50);
+    cache.get(1, out);
+    cache.drain();
+    ok = ok && loads == 1;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void order_tester() {
+    loads = 0;
+    cache_type cache(2, ms(100), loader);
+    Matrix<int> out;
+    cache.save(value_type(1, Matrix<int>(1, 1, 1)));
+    cache.save(value_type(2, Matrix<int>(1, 1, 2)));
+    manual_clock::advance(100);
+    //先读2触发刷新，再读1；刷新完成后2仍是较旧的那个
+    cache.get(2, out);
+    cache.get(1, out);
+    cache.drain();
+    cache.save(value_type(3, Matrix<int>(1, 1, 3)));
+    bool ok = loads == 2 && !cache.get(2, out) && cache.get(1, out) && out[0][0] == 1000 + 2;
+    ok = ok && cache.size() == 2;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void save_wins_tester() {
+    loads = 0;
+    std::atomic<bool> started{false}, release{false};
+    cache_type cache(10, ms(100), [&](int key) {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return loader(key);
+    });
+    Matrix<int> out;
+    cache.save(value_type(1, Matrix<int>(1, 1, 1)));
+    manual_clock::advance(100);
+    cache.get(1, out);
+    while (!started) {
+        std::this_thread::yield();
+    }
+    cache.save(value_type(1, Matrix<int>(1, 1, 77)));
+    release = true;
+    cache.drain();
+    bool ok = loads == 1 && cache.get(1, out) && out[0][0] == 77;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void failure_tester() {
+    std::atomic<int> attempts{0};
+    cache_type cache(10, ms(100), [&attempts](int key) {
+        if (++attempts == 1) {
+            throw std::runtime_error("load failed");
+        }
+        return Matrix<int>(1, 1, key * 10);
+    });
+    Matrix<int> out;
+    cache.save(value_type(4, Matrix<int>(1, 1, 4)));
+    manual_clock::advance(100);
+    cache.get(4, out);
+    cache.drain();
+    bool ok = attempts == 1 && cache.get(4, out) && out[0][0] == 4;
+    cache.drain();
+    ok = ok && attempts == 2 && cache.get(4, out) && out[0][0] == 40;
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void save_during_refresh_tester() {
+    std::atomic<int> calls{0};
+    std::atomic<bool> release{false};
+    //两个后台线程，多排上的刷新会马上开始执行
+    cache_type cache(10, ms(100), [&](int key) {
+        ++calls;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return Matrix<int>(1, 1, key);
+    }, 2);
+    Matrix<int> out;
+    cache.save(value_type(1, Matrix<int>(1, 1, 1)));
+    manual_clock::advance(100);
+    cache.get(1, out);
+    while (calls == 0) {
+        std::this_thread::yield();
+    }
+    //刷新还没结束时save，再等到save的值也过期；这时的get不能再排一次刷新
+    cache.save(value_type(1, Matrix<int>(1, 1, 5)));
+    manual_clock::advance(100);
+    bool ok = cache.get(1, out) && out[0][0] == 5;
+    std::this_thread::sleep_for(ms(20));
+    ok = ok && calls == 1;
+    release = true;
+    cache.drain();
+    //被作废的那次刷新结束后标记清掉，之后的get又能触发刷新
+    ok = ok && cache.get(1, out) && out[0][0] == 5;
+    cache.drain();
+    ok = ok && calls == 2 && cache.get(1, out) && out[0][0] == 1;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    threshold_tester();
+    refresh_tester();
+    order_tester();
+    save_wins_tester();
+    failure_tester();
+    save_during_refresh_tester();
+    std::cout << c[8] << std::endl;
+}
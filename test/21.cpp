@@ -0,0 +1,199 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <random>
+#include <vector>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: hashmap find & remove while migrating",
+    "test2: linked_hashmap find & remove while migrating",
+    "test3: linked_hashmap iteration while migrating",
+    "test4: lru keeps order across migrations",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+using value_type = sjtu::pair<const int, int>;
+
+//插入直到刚开始一轮搬迁，返回插入了多少个
+template<class Map>
+int fill_until_rehashing(Map &map, int from) {
+    int i = from;
+    while (!map.rehashing()) {
+        map.insert(value_type(i, i * 7));
+        ++i;
+    }
+    return i;
+}
+
+//搬迁进行到一半时：旧表里的键、新表里的键、搬迁期间新插入的键都能查到，删除后都查不到
+template<class Map>
+bool half_migrated_check(Map &map) {
+    bool ok = true;
+    size_t base = map.size(); //之前已有的其他元素
+    int n = fill_until_rehashing(map, 0);
+    //扩容那次插入只分配了新表，没有一次性搬完
+    ok = ok && map.rehashing();
+    //再插入一些，搬走一部分旧桶，但不搬完
+    int m = n + 2;
+    for (int i = n; i < m; ++i) {
+        map.insert(value_type(i, i * 7));
+    }
+    ok = ok && map.rehashing();
+    for (int i = 0; i < m; ++i) {
+        auto it = map.find(i);
+        ok = ok && it != map.end() && it->second == i * 7 && map.count(i) == 1;
+    }
+    ok = ok && map.find(m) == map.end();
+    //已存在的键更新值，不新增
+    map.insert(value_type(1, -1));
+    ok = ok && map.find(1)->second == -1 && map.size() == base + m;
+    //删掉一半，剩下的仍然都能查到
+    for (int i = 0; i < m; i += 2) {
+        ok = ok && map.remove(i);
+    }
+    for (int i = 0; i < m; ++i) {
+        ok = ok && (map.find(i) != map.end()) == (i % 2 == 1);
+    }
+    ok = ok && !map.remove(0) && map.size() == base + m / 2;
+    return ok;
+}
+
+//linked_hashmap按迭代器删除，返回是否找到
+bool remove_key(sjtu::linked_hashmap<int, int> &map, int key) {
+    auto it = map.find(key);
+    if (it == map.end()) {
+        return false;
+    }
+    map.remove(it);
+    return true;
+}
+
+void hashmap_tester() {
+    bool ok = true;
+    for (int round = 0; round < 6 && ok; ++round) {
+        sjtu::hashmap<int, int> map;
+        for (int i = 0; i < (16 << round); ++i) {
+            map.insert(value_type(-1 - i, i));
+        }
+        while (map.rehashing()) {
+            map.remove(-1000000);
+        }
+        ok = ok && half_migrated_check(map);
+    }
+    //拷贝一张正在搬迁的表
+    sjtu::hashmap<int, int> map;
+    int n = fill_until_rehashing(map, 0);
+    sjtu::hashmap<int, int> copy(map);
+    for (int i = 0; i < n; ++i) {
+        ok = ok && copy.find(i) != copy.end() && copy.find(i)->second == i * 7;
+    }
+    ok = ok && copy.size() == map.size();
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void linked_hashmap_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<int, int> map;
+    int n = fill_until_rehashing(map, 0);
+    ok = ok && map.rehashing();
+    int m = n + 2;
+    for (int i = n; i < m; ++i) {
+        map.insert(value_type(i, i * 7));
+    }
+    ok = ok && map.rehashing();
+    for (int i = 0; i < m; ++i) {
+        auto it = map.find(i);
+        ok = ok && it != map.end() && it->second == i * 7 && map.count(i) == 1;
+    }
+    for (int i = 0; i < m; i += 3) {
+        ok = ok && remove_key(map, i);
+    }
+    for (int i = 0; i < m; ++i) {
+        ok = ok && (map.find(i) != map.end()) == (i % 3 != 0);
+    }
+    //继续插入直到搬完，之前的元素都还在
+    int k = m;
+    while (map.rehashing()) {
+        map.insert(value_type(k, k * 7));
+        ++k;
+    }
+    for (int i = 0; i < k; ++i) {
+        ok = ok && (map.find(i) != map.end()) == (i >= m || i % 3 != 0);
+    }
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void iteration_tester() {
+    bool ok = true;
+    std::mt19937 rng(11);
+    sjtu::linked_hashmap<int, int> map;
+    std::vector<int> order; //期望的插入顺序
+    int next = 0;
+    //反复穿过多轮扩容，每次处在搬迁中时检查遍历顺序
+    int checked = 0;
+    for (int step = 0; step < 20000; ++step) {
+        int op = rng() % 4;
+        if (op == 0 && !order.empty()) {
+            size_t pos = rng() % order.size();
+            ok = ok && remove_key(map, order[pos]);
+            order.erase(order.begin() + pos);
+        } else if (op == 1 && !order.empty()) {
+            //已存在的键重新insert会移到尾部
+            size_t pos = rng() % order.size();
+            int key = order[pos];
+            map.insert(value_type(key, key * 7));
+            order.erase(order.begin() + pos);
+            order.push_back(key);
+        } else {
+            map.insert(value_type(next, next * 7));
+            order.push_back(next++);
+        }
+        if (map.rehashing() && step % 7 == 0) {
+            ++checked;
+            size_t i = 0;
+            for (auto it = map.begin(); it != map.end(); ++it, ++i) {
+                ok = ok && i < order.size() && it->first == order[i] && it->second == order[i] * 7;
+            }
+            ok = ok && i == order.size() && map.size() == order.size();
+        }
+    }
+    ok = ok && checked > 0;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void lru_tester() {
+    bool ok = true;
+    using cache_type = sjtu::lru<int, int, std::hash<int>, std::equal_to<int> >;
+    cache_type cache(1000);
+    //构造时按容量预留了桶，调回最少的桶数，让之后的save经历多轮渐进式扩容
+    cache.rehash(1);
+    for (int i = 0; i < 1000; ++i) {
+        cache.save(value_type(i, i));
+    }
+    //访问过的0~99变成最近使用，再存100个新键淘汰的是100~199
+    for (int i = 0; i < 100; ++i) {
+        ok = ok && cache.get(i) != nullptr;
+    }
+    for (int i = 1000; i < 1100; ++i) {
+        cache.save(value_type(i, i));
+    }
+    for (int i = 0; i < 1100; ++i) {
+        int *value = cache.get(i);
+        ok = ok && ((i >= 100 && i < 200) ? value == nullptr : value != nullptr && *value == i);
+    }
+    ok = ok && cache.size() == 1000;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    hashmap_tester();
+    linked_hashmap_tester();
+    iteration_tester();
+    lru_tester();
+    std::cout << c[6] << std::endl;
+}
@@ -0,0 +1,245 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: node_pool reuse & release",
+    "test2: linked_hashmap reuses removed nodes",
+    "test3: lru reuses evicted nodes",
+    "test4: clear destroys every element once",
+    "test5: maps usable after clear",
+    "test6: copy that throws midway",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//记录存活对象个数的值
+struct Counted {
+    static inline int alive = 0;
+    int val;
+
+    Counted(int v) : val(v) {
+        ++alive;
+    }
+
+    Counted(const Counted &other) : val(other.val) {
+        ++alive;
+    }
+
+    Counted &operator=(const Counted &other) = default;
+
+    ~Counted() {
+        --alive;
+    }
+};
+
+using node_type = sjtu::Node<int>;
+
+void node_pool_tester() {
+    bool ok = true;
+    sjtu::node_pool<node_type> pool;
+    std::vector<node_type *> nodes;
+    for (int i = 0; i < 100; ++i) {
+        nodes.push_back(pool.create(i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        ok = ok && nodes[i]->data == i;
+    }
+    //刚还回去的节点最先被取出
+    node_type *freed = nodes[42];
+    pool.destroy(freed);
+    node_type *again = pool.create(7);
+    ok = ok && again == freed && again->data == 7;
+    //reserve之后再取的节点都来自同一块，地址连续
+    for (auto *node: nodes) {
+        if (node != freed) {
+            pool.destroy(node);
+        }
+    }
+    pool.destroy(again);
+    pool.release();
+    pool.reserve(1000);
+    node_type *first = pool.create(0);
+    bool contiguous = true;
+    for (int i = 1; i < 1000; ++i) {
+        contiguous = contiguous && pool.create(i) == first + i;
+    }
+    ok = ok && contiguous;
+    pool.release();
+    ok = ok && pool.create(1)->data == 1;
+    pool.release();
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void linked_hashmap_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<int, int> map;
+    for (int i = 0; i < 50; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i));
+    }
+    //删掉的节点被下一次插入复用，不再申请内存
+    for (int i = 0; i < 50; ++i) {
+        int *old = &map.find(i)->second;
+        map.remove(map.find(i));
+        map.insert(sjtu::pair<const int, int>(i + 1000, i));
+        ok = ok && &map.find(i + 1000)->second == old;
+    }
+    ok = ok && map.size() == 50;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void lru_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(4);
+    //先插入再淘汰，所以反复存新键时所有元素只在capacity+1个节点里轮换
+    std::vector<Matrix<int> *> seen;
+    for (int i = 0; i < 1000; ++i) {
+        cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(i), Matrix<int>(1, 1, i)));
+        Matrix<int> *added = cache.get(i);
+        ok = ok && added != nullptr && (*added)[0][0] == i;
+        if (std::find(seen.begin(), seen.end(), added) == seen.end()) {
+            seen.push_back(added);
+        }
+    }
+    ok = ok && seen.size() <= 5 && cache.size() == 4;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void clear_tester() {
+    bool ok = true;
+    {
+        sjtu::linked_hashmap<int, Counted> linked;
+        sjtu::hashmap<int, Counted> chained;
+        for (int i = 0; i < 1000; ++i) {
+            linked.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+            chained.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            linked.remove(linked.find(i));
+            chained.remove(i);
+        }
+        ok = ok && Counted::alive == 1000;
+        linked.clear();
+        ok = ok && Counted::alive == 500;
+        chained.clear();
+        ok = ok && Counted::alive == 0 && linked.size() == 0 && chained.size() == 0;
+        for (int i = 0; i < 10; ++i) {
+            linked.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+            chained.insert(sjtu::pair<const int, Counted>(i, Counted(i)));
+        }
+    }
+    //析构时剩下的元素也只析构一次
+    ok = ok && Counted::alive == 0;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void reuse_after_clear_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<int, int> linked;
+    sjtu::hashmap<int, int> chained;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 5000; ++i) {
+            linked.insert(sjtu::pair<const int, int>(i, i + round));
+            chained.insert(sjtu::pair<const int, int>(i, i + round));
+        }
+        for (int i = 0; i < 5000; ++i) {
+            ok = ok && linked.find(i)->second == i + round && chained.find(i)->second == i + round;
+        }
+        int expect = 0;
+        for (auto it = linked.begin(); it != linked.end(); ++it) {
+            ok = ok && it->first == expect++;
+        }
+        ok = ok && expect == 5000;
+        linked.clear();
+        chained.clear();
+        ok = ok && linked.empty() && linked.find(1) == linked.end() && chained.find(1) == chained.end();
+    }
+    std::cout << c[6] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+//第copies_left次之后的拷贝抛异常的值，同样记录存活个数
+struct ThrowingCopy {
+    static inline int alive = 0;
+    static inline int copies_left = -1; //小于0表示不抛
+    int val;
+
+    ThrowingCopy(int v) : val(v) {
+        ++alive;
+    }
+
+    ThrowingCopy(const ThrowingCopy &other) : val(other.val) {
+        if (copies_left == 0) {
+            throw std::runtime_error("copy failed");
+        }
+        --copies_left;
+        ++alive;
+    }
+
+    ThrowingCopy &operator=(const ThrowingCopy &other) = default;
+
+    ~ThrowingCopy() {
+        --alive;
+    }
+};
+
+//拷贝到一半抛异常：已经拷好的元素都析构，节点池的节点不被链表delete（ASan下检查），原表不受影响
+template<class Map>
+bool throwing_copy_check(Map &map) {
+    bool ok = true;
+    int before = ThrowingCopy::alive;
+    ThrowingCopy::copies_left = 300;
+    try {
+        Map copy(map);
+        ok = false;
+    } catch (std::runtime_error &) {
+    }
+    ThrowingCopy::copies_left = -1;
+    ok = ok && ThrowingCopy::alive == before;
+    //赋值时同样处理，失败后目标表是空的，还能接着用
+    Map target;
+    target.insert(sjtu::pair<const int, ThrowingCopy>(-1, ThrowingCopy(-1)));
+    ThrowingCopy::copies_left = 300;
+    try {
+        target = map;
+        ok = false;
+    } catch (std::runtime_error &) {
+    }
+    ThrowingCopy::copies_left = -1;
+    ok = ok && ThrowingCopy::alive == before && target.size() == 0;
+    target.insert(sjtu::pair<const int, ThrowingCopy>(1, ThrowingCopy(1)));
+    ok = ok && target.find(1)->second.val == 1 && map.size() == 1000 && map.find(999)->second.val == 999;
+    return ok;
+}
+
+void throwing_copy_tester() {
+    bool ok = true;
+    {
+        sjtu::linked_hashmap<int, ThrowingCopy> linked;
+        sjtu::hashmap<int, ThrowingCopy> chained;
+        for (int i = 0; i < 1000; ++i) {
+            linked.insert(sjtu::pair<const int, ThrowingCopy>(i, ThrowingCopy(i)));
+            chained.insert(sjtu::pair<const int, ThrowingCopy>(i, ThrowingCopy(i)));
+        }
+        ThrowingCopy::copies_left = -1;
+        ok = ok && throwing_copy_check(linked) && throwing_copy_check(chained);
+    }
+    ok = ok && ThrowingCopy::alive == 0;
+    std::cout << c[7] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    node_pool_tester();
+    linked_hashmap_tester();
+    lru_tester();
+    clear_tester();
+    reuse_after_clear_tester();
+    throwing_copy_tester();
+    std::cout << c[8] << std::endl;
+}
@@ -0,0 +1,138 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+#include <vector>
+
+std::string c[] = {
+    "   pass!",
+    "   error.",
+    "test1: get moves the entry to most recent",
+    "test2: get relinks the node in place",
+    "test3: pointers stay valid across later gets",
+    "test4: linked_hashmap touch",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+//记录拷贝次数的值，移动不计
+struct CopyCounted {
+    static inline int copies = 0;
+    int val;
+
+    CopyCounted(int v) : val(v) {
+    }
+
+    CopyCounted(const CopyCounted &other) : val(other.val) {
+        ++copies;
+    }
+
+    CopyCounted(CopyCounted &&other) noexcept : val(other.val) {
+    }
+
+    CopyCounted &operator=(const CopyCounted &other) {
+        val = other.val;
+        ++copies;
+        return *this;
+    }
+
+    CopyCounted &operator=(CopyCounted &&other) noexcept {
+        val = other.val;
+        return *this;
+    }
+};
+
+using cache_type = sjtu::lru<int, CopyCounted, std::hash<int>, std::equal_to<int> >;
+using value_type = sjtu::pair<const int, CopyCounted>;
+
+void order_tester() {
+    bool ok = true;
+    sjtu::lru<> cache(3);
+    for (int i = 1; i <= 3; ++i) {
+        cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(i), Matrix<int>(1, 1, i)));
+    }
+    //读过的1变成最近使用，之后淘汰的依次是2、3
+    ok = ok && cache.get(Integer(1)) != nullptr;
+    cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(4), Matrix<int>(1, 1, 4)));
+    ok = ok && cache.get(Integer(2)) == nullptr;
+    cache.save(sjtu::pair<const Integer, Matrix<int> >(Integer(5), Matrix<int>(1, 1, 5)));
+    ok = ok && cache.get(Integer(3)) == nullptr;
+    Matrix<int> *one = cache.get(Integer(1));
+    ok = ok && one != nullptr && (*one)[0][0] == 1 && cache.size() == 3;
+    std::cout << c[2] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void in_place_tester() {
+    bool ok = true;
+    cache_type cache(10);
+    std::vector<CopyCounted *> first;
+    for (int i = 0; i < 10; ++i) {
+        cache.save(value_type(i, CopyCounted(i)));
+    }
+    for (int i = 0; i < 10; ++i) {
+        first.push_back(cache.get(i));
+    }
+    //命中只改链表指针：节点地址不变，值也不拷贝
+    CopyCounted::copies = 0;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 9; i >= 0; --i) {
+            CopyCounted *value = cache.get(i);
+            ok = ok && value == first[i] && value->val == i;
+        }
+    }
+    ok = ok && CopyCounted::copies == 0 && cache.size() == 10;
+    std::cout << c[3] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void pointer_tester() {
+    bool ok = true;
+    cache_type cache(4);
+    for (int i = 0; i < 4; ++i) {
+        cache.save(value_type(i, CopyCounted(i)));
+    }
+    //拿到0的指针后反复读别的键再读0，0一直没被淘汰，指针一直有效
+    CopyCounted *zero = cache.get(0);
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 1; i < 4; ++i) {
+            ok = ok && cache.get(i)->val == i;
+        }
+        ok = ok && cache.get(0) == zero;
+        zero->val = round;
+        ok = ok && cache.get(0)->val == round;
+    }
+    //通过指针的修改和save的更新写的是同一个节点
+    cache.save(value_type(0, CopyCounted(-1)));
+    ok = ok && zero->val == -1 && cache.get(0) == zero;
+    std::cout << c[4] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+void touch_tester() {
+    bool ok = true;
+    sjtu::linked_hashmap<int, int> map;
+    for (int i = 0; i < 5; ++i) {
+        map.insert(sjtu::pair<const int, int>(i, i));
+    }
+    auto it = map.find(2);
+    int *before = &it->second;
+    map.touch(it);
+    //2移到了最后，其余的相对顺序不变，节点还是原来那个
+    int expect[] = {0, 1, 3, 4, 2};
+    int i = 0;
+    for (auto cur = map.begin(); cur != map.end(); ++cur, ++i) {
+        ok = ok && i < 5 && cur->first == expect[i];
+    }
+    ok = ok && i == 5 && &map.find(2)->second == before;
+    //已经在最后的节点touch不改变任何东西
+    map.touch(map.find(2));
+    ok = ok && &map.find(2)->second == before && map.size() == 5;
+    std::cout << c[5] << (ok ? c[0] : c[1]) << std::endl;
+}
+
+int main() {
+    order_tester();
+    in_place_tester();
+    pointer_tester();
+    touch_tester();
+    std::cout << c[6] << std::endl;
+}
@@ -0,0 +1,175 @@
+#include "src.hpp"
+#if defined (_UNORDERED_MAP_)  || (defined (_LIST_)) || (defined (_MAP_)) || (defined (_SET_)) || (defined (_UNORDERED_SET_))||(defined (_GLIBCXX_MAP)) || (defined (_GLIBCXX_UNORDERED_MAP))
+BOOM :)
+#endif
+#include <iostream>
+#include <string>
+
+std::string c[]={
+    "   pass!",
+    "   error.",
+    "test1: insert & growth",
+    "test2: remove then find",
+    "test3: tombstone reuse",
+    "test4: constructor(), =",
+    "test5: remove & reinsert churn",
+    "test6: clear",
+    "Congratulations. Your submission has passed all correctness tests. Good job! :)",
+};
+
+using value_type = sjtu::pair<const int,int>;
+using mp = sjtu::hashmap<int,int,std::hash<int>,std::equal_to<int>,sjtu::flat_buckets>;
+
+//i%3==0的键已删除，i%4==0的键被更新成4*i，其余的值是i
+bool check(const mp &map,int n){
+    for(int i=0;i<n;i++){
+        mp::iterator it = map.find(i);
+        if(i%3==0){
+            if(it != map.end())return false;
+        }
+        else if(it == map.end() || (*it).second != (i%4==0 ? 4*i : i)){
+            return false;
+        }
+    }
+    return true;
+}
+
+void growth_tester(){
+    //一直插入到扩容很多次，槽数保持16乘以2的幂，负载因子不超过上限
+    mp map;
+    bool ok = map.size() == 0 && map.find(0) == map.end();
+    const int n = 100000;
+    for(int i=0;i<n;i++){
+        map.insert(value_type(i,i));
+        size_t groups = map.bucket_count() / 16;
+        ok = ok && map.bucket_count() % 16 == 0 && (groups & (groups - 1)) == 0;
+        ok = ok && map.load_factor() <= map.max_load_factor();
+    }
+    //已存在的键只更新值
+    for(int i=0;i<n;i+=4){
+        ok = ok && !map.insert(value_type(i,4*i)).second;
+    }
+    for(int i=0;i<n;i++){
+        mp::iterator it = map.find(i);
+        ok = ok && it != map.end() && (*it).second == (i%4==0 ? 4*i : i);
+    }
+    ok = ok && map.size() == n && map.find(n) == map.end();
+    std::cout<<c[2]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+void remove_tester(){
+    mp map;
+    const int n = 100000;
+    for(int i=0;i<n;i++){
+        map.insert(value_type(i,i%4==0 ? 4*i : i));
+    }
+    bool ok = true;
+    for(int i=0;i<n;i+=3){
+        ok = ok && map.remove(i);
+    }
+    //删过的键再删返回false，其余的键都还能找到
+    for(int i=0;i<n;i+=3){
+        ok = ok && !map.remove(i) && map.count(i) == 0;
+    }
+    ok = ok && check(map,n) && map.size() == n - (n+2)/3;
+    std::cout<<c[3]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+void tombstone_tester(){
+    //元素个数不到负载上限的一半，不断删旧键插新键：满了的组里删除会留墓碑，
+    //墓碑要被复用或者原地重建清掉，元素个数不变，槽数不能增长
+    mp map;
+    map.reserve(1000);
+    const size_t buckets = map.bucket_count();
+    const int live = static_cast<int>(buckets * 7 / 16) - 1;
+    for(int i=0;i<live;i++){
+        map.insert(value_type(i,i));
+    }
+    bool ok = true;
+    for(int i=live;i<live*20;i++){
+        ok = ok && map.remove(i-live);
+        map.insert(value_type(i,i));
+        //删掉的键后面探测序列上的键仍然找得到
+        ok = ok && map.find(i-live) == map.end() && map.find(i-live+1) != map.end();
+    }
+    for(int i=live*19;i<live*20;i++){
+        mp::iterator it = map.find(i);
+        ok = ok && it != map.end() && (*it).second == i;
+    }
+    ok = ok && map.size() == static_cast<size_t>(live) && map.bucket_count() == buckets;
+    std::cout<<c[4]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+void copy_tester(){
+    mp map;
+    const int n = 10000;
+    for(int i=0;i<n;i++){
+        map.insert(value_type(i,i%4==0 ? 4*i : i));
+    }
+    for(int i=0;i<n;i+=3){
+        map.remove(i);
+    }
+    mp map2(map);
+    bool ok = check(map2,n);
+    map2.clear();
+    map2 = map;
+    ok = ok && check(map2,n) && map2.size() == map.size();
+    //拷贝出来的表互不影响
+    map2.remove(1);
+    ok = ok && map.find(1) != map.end();
+    std::cout<<c[5]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+//反复删除再插入，墓碑不能让查找出错，也不能让表无限变大
+void churn_tester(){
+    using matrix_value = sjtu::pair<Integer,Matrix<int> >;
+    using matrix_map = sjtu::hashmap<Integer,Matrix<int>,Hash,Equal,sjtu::flat_buckets>;
+    const int n = 1000;
+    matrix_map map;
+    for(int i=0;i<n;i++){
+        map.insert(matrix_value(Integer(i),Matrix<int>(2,2,i)));
+    }
+    bool ok = true;
+    for(int round=0;round<50;round++){
+        for(int i=round;i<n;i+=7){
+            map.remove(Integer(i));
+        }
+        for(int i=round;i<n;i+=7){
+            map.insert(matrix_value(Integer(i),Matrix<int>(2,2,i+round)));
+        }
+        for(int i=0;i<n;i++){
+            ok = ok && map.find(Integer(i)) != map.end();
+        }
+    }
+    map[Integer(n)] = Matrix<int>(1,1,n);
+    ok = ok && map.find(Integer(n))->second == Matrix<int>(1,1,n) && map.remove(Integer(n)) && !map.remove(Integer(n));
+    std::cout<<c[6]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+void clear_tester(){
+    mp map;
+    for(int i=0;i<1000;i++){
+        map.insert(value_type(i,i));
+    }
+    size_t buckets = map.bucket_count();
+    map.clear();
+    map.clear();
+    //清空后保留槽，还能接着用
+    bool ok = map.size() == 0 && map.find(1) == map.end() && map.bucket_count() == buckets;
+    map.insert(value_type(1,2));
+    ok = ok && map.find(1)->second == 2 && map.size() == 1;
+    std::cout<<c[7]<<(ok ? c[0] : c[1])<<std::endl;
+}
+
+int main(){
+#ifdef _OUTPUT_
+    freopen("9.out","w",stdout);
+#endif
+    growth_tester();
+    remove_tester();
+    tombstone_tester();
+    copy_tester();
+    churn_tester();
+    clear_tester();
+    std::cout << c[8] << std::endl;
+}